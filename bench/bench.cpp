@@ -0,0 +1,555 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "fonctions.hpp"
+
+// Banc de mesure : chaque noyau de fonctions.hpp est chronométré à côté de son
+// équivalent OpenCV, sur les images du dossier Images/ et sur des images
+// synthétiques de 1 à 64 Mpx. On garde la médiane et le 95e centile des temps, et le
+// débit en pixels par nanoseconde, pour suivre les régressions d'une version à l'autre.
+
+typedef std::function<void(const cv::Mat&, cv::Mat&)> FonctionNoyau;
+
+struct Implementation {
+    std::string nom;
+    FonctionNoyau fonction;
+};
+
+struct Noyau {
+    std::string nom;
+    std::vector<Implementation> implementations;
+};
+
+struct Mesure {
+    std::string noyau;
+    std::string implementation;
+    std::string image;
+    int largeur;
+    int hauteur;
+    double medianeMs;
+    double p95Ms;
+    double pixelsParNs;
+};
+
+struct ImageBench {
+    std::string nom;
+    cv::Mat image;
+};
+
+void histogrammeOpenCV(const cv::Mat& image, cv::Mat& hist) {
+    int channels[] = {0};
+    int histSize[] = {256};
+    float range[] = {0, 256};
+    const float* ranges[] = {range};
+    cv::calcHist(&image, 1, channels, cv::Mat(), hist, 1, histSize, ranges, true, false);
+}
+
+cv::Mat filtreMoyenne(int taille) {
+    return cv::Mat(taille, taille, CV_64F, cv::Scalar(1.0 / (taille * taille)));
+}
+
+// Noyau gaussien de rayon 3 sigma, celui que cv::GaussianBlur prend pour une image 8 bits
+cv::Mat filtreGaussien(double sigma) {
+    int rayon = static_cast<int>(std::ceil(3.0 * sigma));
+    std::vector<double> poids(2 * rayon + 1);
+    double total = 0.0;
+    for (int k = -rayon; k <= rayon; ++k) {
+        poids[k + rayon] = std::exp(-k * k / (2.0 * sigma * sigma));
+        total += poids[k + rayon];
+    }
+    cv::Mat filtre(2 * rayon + 1, 2 * rayon + 1, CV_64F);
+    for (int y = 0; y < filtre.rows; ++y) {
+        for (int x = 0; x < filtre.cols; ++x) {
+            filtre.at<double>(y, x) = poids[y] * poids[x] / (total * total);
+        }
+    }
+    return filtre;
+}
+
+// Sigmas du flou gaussien récursif, mesurés en temps et en écart à cv::GaussianBlur
+const double SIGMAS_GAUSS[] = {2.0, 8.0, 32.0};
+const size_t NB_SIGMAS_GAUSS = sizeof(SIGMAS_GAUSS) / sizeof(SIGMAS_GAUSS[0]);
+
+struct Ecart {
+    std::string image;
+    double sigma;
+    double maximum;
+    double moyenne;
+};
+
+// Germes de la croissance de régions : une grille de 4 x 4 points
+std::vector<cv::Point> germesGrille(const cv::Mat& image) {
+    std::vector<cv::Point> germes;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            germes.push_back(cv::Point((2 * j + 1) * image.cols / 8, (2 * i + 1) * image.rows / 8));
+        }
+    }
+    return germes;
+}
+
+// Les mêmes 16 germes, en marqueurs étiquetés de 1 à 16 pour la ligne de partage des eaux
+cv::Mat marqueursGrille(const cv::Mat& image) {
+    std::vector<cv::Point> germes = germesGrille(image);
+    cv::Mat marqueurs(image.size(), CV_32S, cv::Scalar(0));
+    for (size_t i = 0; i < germes.size(); ++i) {
+        marqueurs.at<int>(germes[i]) = static_cast<int>(i + 1);
+    }
+    return marqueurs;
+}
+
+// La liste des noyaux mesurés : nos implémentations d'abord, celles d'OpenCV ensuite
+std::vector<Noyau> noyauxBench() {
+    std::vector<Noyau> noyaux;
+
+    Noyau histogramme = {"histogramme", {
+        {"monCalcHistNaif", [](const cv::Mat& image, cv::Mat& sortie) { monCalcHistNaif(image, sortie); }},
+        {"monCalcHist 1 thread", [](const cv::Mat& image, cv::Mat& sortie) { monCalcHistParallele(image, sortie, 1); }},
+        {"monCalcHist", [](const cv::Mat& image, cv::Mat& sortie) { monCalcHist(image, sortie); }},
+        {"cv::calcHist", histogrammeOpenCV}}};
+    noyaux.push_back(histogramme);
+
+    Noyau egalisation = {"egalisation", {
+        {"egaliseHist", [](const cv::Mat& image, cv::Mat& sortie) { egaliseHist(image, sortie); }},
+        {"cv::equalizeHist", [](const cv::Mat& image, cv::Mat& sortie) { cv::equalizeHist(image, sortie); }}}};
+    noyaux.push_back(egalisation);
+
+    Noyau clahe = {"clahe 8x8", {
+        {"egaliserHistogrammeClahe 1 thread", [](const cv::Mat& image, cv::Mat& sortie) {
+            egaliserHistogrammeClahe(image, sortie, 2.0, 8, 8, 1);
+        }},
+        {"egaliserHistogrammeClahe", [](const cv::Mat& image, cv::Mat& sortie) {
+            egaliserHistogrammeClahe(image, sortie, 2.0, 8, 8);
+        }},
+        {"cv::createCLAHE", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::createCLAHE(2.0, cv::Size(8, 8))->apply(image, sortie);
+        }}}};
+    noyaux.push_back(clahe);
+
+    // Pas d'équivalent OpenCV à l'égalisation locale ; la moyenne et l'écart-type locaux
+    // se comparent à deux cv::blur en flottant
+    Noyau egalisationLocale = {"egalisation locale r31", {
+        {"egaliserHistogrammeLocal 1 thread", [](const cv::Mat& image, cv::Mat& sortie) {
+            egaliserHistogrammeLocal(image, sortie, 31, 1);
+        }},
+        {"egaliserHistogrammeLocal", [](const cv::Mat& image, cv::Mat& sortie) {
+            egaliserHistogrammeLocal(image, sortie, 31);
+        }}}};
+    noyaux.push_back(egalisationLocale);
+
+    Noyau statistiques = {"statistiques locales r31", {
+        {"statistiquesLocales", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat ecartType;
+            statistiquesLocales(image, sortie, ecartType, 31);
+        }},
+        {"cv::blur", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat flottante, carres, moyenneCarres;
+            image.convertTo(flottante, CV_32F);
+            cv::blur(flottante, sortie, cv::Size(63, 63), cv::Point(-1, -1), cv::BORDER_REFLECT_101);
+            cv::multiply(flottante, flottante, carres);
+            cv::blur(carres, moyenneCarres, cv::Size(63, 63), cv::Point(-1, -1), cv::BORDER_REFLECT_101);
+        }}}};
+    noyaux.push_back(statistiques);
+
+    Noyau etirement = {"etirement", {
+        {"etirerHistogramme", [](const cv::Mat& image, cv::Mat& sortie) { etirerHistogramme(image, sortie, 0, 255); }},
+        {"cv::normalize", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::normalize(image, sortie, 0, 255, cv::NORM_MINMAX, CV_8U);
+        }}}};
+    noyaux.push_back(etirement);
+
+    // Un histogramme puis une table : le coût de Otsu 4 classes est celui de 2 classes
+    Noyau otsu = {"otsu", {
+        {"segmenterOtsu 2 classes", [](const cv::Mat& image, cv::Mat& sortie) { segmenterOtsu(image, sortie, 2); }},
+        {"segmenterOtsu 4 classes", [](const cv::Mat& image, cv::Mat& sortie) { segmenterOtsu(image, sortie, 4); }},
+        {"cv::threshold", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::threshold(image, sortie, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        }}}};
+    noyaux.push_back(otsu);
+
+    // Fenêtre 31 x 31 : les sommes viennent des images intégrales, quelle que soit la taille
+    Noyau adaptatif = {"seuillage adaptatif 31", {
+        {"seuillageAdaptatif moyenne 1 thread", [](const cv::Mat& image, cv::Mat& sortie) {
+            seuillageAdaptatif(image, sortie, OptionsSeuillage(SEUIL_MOYENNE, 31), 1);
+        }},
+        {"seuillageAdaptatif moyenne", [](const cv::Mat& image, cv::Mat& sortie) {
+            seuillageAdaptatif(image, sortie, OptionsSeuillage(SEUIL_MOYENNE, 31));
+        }},
+        {"seuillageAdaptatif gaussien", [](const cv::Mat& image, cv::Mat& sortie) {
+            seuillageAdaptatif(image, sortie, OptionsSeuillage(SEUIL_GAUSSIEN, 31));
+        }},
+        {"seuillageAdaptatif Sauvola", [](const cv::Mat& image, cv::Mat& sortie) {
+            seuillageAdaptatif(image, sortie, OptionsSeuillage(SEUIL_SAUVOLA, 31));
+        }},
+        {"cv::adaptiveThreshold moyenne", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::adaptiveThreshold(image, sortie, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 31, 5.0);
+        }},
+        {"cv::adaptiveThreshold gaussien", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::adaptiveThreshold(image, sortie, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 31, 5.0);
+        }}}};
+    noyaux.push_back(adaptatif);
+
+    // Sur l'image seuillée par Otsu : le seuillage, le même partout, est compté dans
+    // chaque mesure
+    Noyau etiquetage = {"etiquetage 8-connexe", {
+        {"etiqueterComposantes 1 thread", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat binaire;
+            cv::threshold(image, binaire, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+            std::vector<Composante> composantes;
+            etiqueterComposantes(binaire, sortie, composantes, 8, 1);
+        }},
+        {"etiqueterComposantes", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat binaire;
+            cv::threshold(image, binaire, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+            std::vector<Composante> composantes;
+            etiqueterComposantes(binaire, sortie, composantes, 8);
+        }},
+        {"etiqueterComposantes sans statistiques", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat binaire;
+            cv::threshold(image, binaire, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+            etiqueterComposantes(binaire, sortie, 8);
+        }},
+        {"cv::connectedComponentsWithStats", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat binaire, stats, centres;
+            cv::threshold(image, binaire, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+            cv::connectedComponentsWithStats(binaire, sortie, stats, centres, 8);
+        }}}};
+    noyaux.push_back(etiquetage);
+
+    // Pas d'équivalent exact dans OpenCV : cv::floodFill fait croître une région par germe,
+    // l'une après l'autre, avec un écart fixe au niveau du germe
+    Noyau croissance = {"croissance 16 germes", {
+        {"croissanceRegions", [](const cv::Mat& image, cv::Mat& sortie) {
+            croissanceRegions(image, germesGrille(image), sortie);
+        }},
+        {"cv::floodFill", [](const cv::Mat& image, cv::Mat& sortie) {
+            std::vector<cv::Point> germes = germesGrille(image);
+            sortie = cv::Mat::zeros(image.rows + 2, image.cols + 2, CV_8UC1);
+            cv::Mat copie = image.clone();
+            for (size_t i = 0; i < germes.size(); ++i) {
+                int drapeaux = 4 | cv::FLOODFILL_MASK_ONLY | cv::FLOODFILL_FIXED_RANGE | static_cast<int>((i + 1) << 8);
+                cv::floodFill(copie, sortie, germes[i], cv::Scalar(), 0, cv::Scalar(32), cv::Scalar(32), drapeaux);
+            }
+        }}}};
+    noyaux.push_back(croissance);
+
+    // cv::watershed calcule son propre relief sur une image couleur : chaque variante
+    // compte donc aussi le passage de l'image au relief
+    Noyau partage = {"ligne de partage des eaux 16 marqueurs", {
+        {"ligneDePartageEaux", [](const cv::Mat& image, cv::Mat& sortie) {
+            sortie = marqueursGrille(image);
+            ligneDePartageEaux(gradientSobel(image), sortie);
+        }},
+        {"ligneDePartageEauxTuiles 1 thread", [](const cv::Mat& image, cv::Mat& sortie) {
+            sortie = marqueursGrille(image);
+            ligneDePartageEauxTuiles(gradientSobel(image), sortie, TAILLE_TUILE_PARTAGE, 1);
+        }},
+        {"ligneDePartageEauxTuiles", [](const cv::Mat& image, cv::Mat& sortie) {
+            sortie = marqueursGrille(image);
+            ligneDePartageEauxTuiles(gradientSobel(image), sortie);
+        }},
+        {"cv::watershed", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::Mat couleur;
+            cv::cvtColor(image, couleur, cv::COLOR_GRAY2BGR);
+            sortie = marqueursGrille(image);
+            cv::watershed(couleur, sortie);
+        }}}};
+    noyaux.push_back(partage);
+
+    cv::Mat filtreContours = (cv::Mat_<double>(3, 3) << -1, -1, -1, -1, 8, -1, -1, -1, -1);
+    Noyau contours = {"contours 3x3", {
+        {"appliquerFiltre", [filtreContours](const cv::Mat& image, cv::Mat& sortie) {
+            sortie = appliquerFiltre(image, filtreContours);
+        }},
+        {"cv::filter2D", [filtreContours](const cv::Mat& image, cv::Mat& sortie) {
+            cv::filter2D(image, sortie, CV_8U, filtreContours);
+        }}}};
+    noyaux.push_back(contours);
+
+    cv::Mat filtreGauss = (cv::Mat_<double>(3, 3) << 1.0/16, 2.0/16, 1.0/16, 2.0/16, 4.0/16, 2.0/16, 1.0/16, 2.0/16, 1.0/16);
+    Noyau gauss = {"gauss 3x3", {
+        {"appliquerFiltre", [filtreGauss](const cv::Mat& image, cv::Mat& sortie) {
+            sortie = appliquerFiltre(image, filtreGauss);
+        }},
+        {"cv::GaussianBlur", [](const cv::Mat& image, cv::Mat& sortie) {
+            cv::GaussianBlur(image, sortie, cv::Size(3, 3), 0);
+        }}}};
+    noyaux.push_back(gauss);
+
+    const int taillesFlou[] = {3, 15, 31};
+    for (size_t i = 0; i < sizeof(taillesFlou) / sizeof(taillesFlou[0]); ++i) {
+        int taille = taillesFlou[i];
+        cv::Mat filtreBlur = filtreMoyenne(taille);
+        Noyau flou = {"flou " + std::to_string(taille) + "x" + std::to_string(taille), {
+            {"appliquerFiltre", [filtreBlur](const cv::Mat& image, cv::Mat& sortie) {
+                sortie = appliquerFiltre(image, filtreBlur);
+            }},
+            {"moyenneBoite", [taille](const cv::Mat& image, cv::Mat& sortie) {
+                sortie = moyenneBoite(image, taille, taille);
+            }},
+            {"cv::filter2D", [filtreBlur](const cv::Mat& image, cv::Mat& sortie) {
+                cv::filter2D(image, sortie, CV_8U, filtreBlur);
+            }},
+            {"cv::blur", [taille](const cv::Mat& image, cv::Mat& sortie) {
+                cv::blur(image, sortie, cv::Size(taille, taille));
+            }}}};
+        noyaux.push_back(flou);
+    }
+
+    // Le noyau de appliquerFiltre a 6 sigma de côté : son coût grandit avec sigma, celui
+    // du filtre récursif non
+    for (size_t i = 0; i < NB_SIGMAS_GAUSS; ++i) {
+        double sigma = SIGMAS_GAUSS[i];
+        cv::Mat filtre = filtreGaussien(sigma);
+        Noyau gaussSigma = {"gauss sigma " + std::to_string(static_cast<int>(sigma)), {
+            {"flouGaussienRecursif 1 thread", [sigma](const cv::Mat& image, cv::Mat& sortie) {
+                sortie = flouGaussienRecursif(image, sigma, 1);
+            }},
+            {"flouGaussienRecursif", [sigma](const cv::Mat& image, cv::Mat& sortie) {
+                sortie = flouGaussienRecursif(image, sigma);
+            }},
+            {"appliquerFiltre", [filtre](const cv::Mat& image, cv::Mat& sortie) {
+                sortie = appliquerFiltre(image, filtre, BORD_REPLIQUE);
+            }},
+            {"cv::GaussianBlur", [sigma](const cv::Mat& image, cv::Mat& sortie) {
+                cv::GaussianBlur(image, sortie, cv::Size(0, 0), sigma, sigma, cv::BORDER_REPLICATE);
+            }}}};
+        noyaux.push_back(gaussSigma);
+    }
+
+    const int taillesMedian[] = {3, 5, 31};
+    for (size_t i = 0; i < sizeof(taillesMedian) / sizeof(taillesMedian[0]); ++i) {
+        int taille = taillesMedian[i];
+        Noyau median = {"median " + std::to_string(taille) + "x" + std::to_string(taille), {
+            {"filtreMedian 1 thread", [taille](const cv::Mat& image, cv::Mat& sortie) {
+                sortie = filtreMedian(image, taille, BORD_REPLIQUE, 1);
+            }},
+            {"filtreMedian", [taille](const cv::Mat& image, cv::Mat& sortie) { sortie = filtreMedian(image, taille); }},
+            {"cv::medianBlur", [taille](const cv::Mat& image, cv::Mat& sortie) {
+                cv::medianBlur(image, sortie, taille);
+            }}}};
+        noyaux.push_back(median);
+    }
+
+    return noyaux;
+}
+
+// Chronomètre `repetitions` appels (après un appel de chauffe) et remplit la mesure
+void mesurer(const FonctionNoyau& fonction, const cv::Mat& image, int repetitions, Mesure& mesure) {
+    cv::Mat sortie;
+    fonction(image, sortie);
+
+    std::vector<double> temps;
+    for (int r = 0; r < repetitions; ++r) {
+        int64_t debut = cv::getTickCount();
+        fonction(image, sortie);
+        int64_t fin = cv::getTickCount();
+        temps.push_back((fin - debut) * 1000.0 / cv::getTickFrequency());
+    }
+    std::sort(temps.begin(), temps.end());
+
+    // Médiane et 95e centile (rang le plus proche)
+    size_t rangP95 = static_cast<size_t>(std::ceil(0.95 * temps.size()));
+    mesure.medianeMs = temps[temps.size() / 2];
+    mesure.p95Ms = temps[std::min(temps.size(), std::max<size_t>(rangP95, 1)) - 1];
+    mesure.pixelsParNs = static_cast<double>(image.total()) / (mesure.medianeMs * 1e6);
+}
+
+// Écart maximal et moyen, en niveaux de gris, entre le flou récursif et cv::GaussianBlur
+Ecart mesurerEcartGauss(const ImageBench& imageBench, double sigma) {
+    cv::Mat recursif = flouGaussienRecursif(imageBench.image, sigma), reference;
+    cv::GaussianBlur(imageBench.image, reference, cv::Size(0, 0), sigma, sigma, cv::BORDER_REPLICATE);
+    Ecart ecart = {imageBench.nom, sigma, 0.0, 0.0};
+    for (int y = 0; y < recursif.rows; ++y) {
+        const uchar* a = recursif.ptr<uchar>(y);
+        const uchar* b = reference.ptr<uchar>(y);
+        for (int x = 0; x < recursif.cols; ++x) {
+            double difference = std::abs(a[x] - b[x]);
+            ecart.maximum = std::max(ecart.maximum, difference);
+            ecart.moyenne += difference;
+        }
+    }
+    ecart.moyenne /= static_cast<double>(recursif.total());
+    return ecart;
+}
+
+std::string echapperJson(const std::string& texte) {
+    std::string resultat;
+    for (size_t i = 0; i < texte.size(); ++i) {
+        if (texte[i] == '"' || texte[i] == '\\') {
+            resultat += '\\';
+        }
+        resultat += texte[i];
+    }
+    return resultat;
+}
+
+bool ecrireCsv(const std::string& chemin, const std::vector<Mesure>& mesures) {
+    std::ofstream fichier(chemin.c_str());
+    fichier << "noyau,implementation,image,largeur,hauteur,mediane_ms,p95_ms,pixels_par_ns\n";
+    for (size_t i = 0; i < mesures.size(); ++i) {
+        const Mesure& m = mesures[i];
+        fichier << m.noyau << ',' << m.implementation << ',' << m.image << ',' << m.largeur << ',' << m.hauteur << ','
+                << m.medianeMs << ',' << m.p95Ms << ',' << m.pixelsParNs << '\n';
+    }
+    return static_cast<bool>(fichier);
+}
+
+bool ecrireJson(const std::string& chemin, const std::vector<Mesure>& mesures) {
+    std::ofstream fichier(chemin.c_str());
+    fichier << "[\n";
+    for (size_t i = 0; i < mesures.size(); ++i) {
+        const Mesure& m = mesures[i];
+        fichier << "  {\"noyau\": \"" << echapperJson(m.noyau) << "\", \"implementation\": \""
+                << echapperJson(m.implementation) << "\", \"image\": \"" << echapperJson(m.image)
+                << "\", \"largeur\": " << m.largeur << ", \"hauteur\": " << m.hauteur
+                << ", \"mediane_ms\": " << m.medianeMs << ", \"p95_ms\": " << m.p95Ms
+                << ", \"pixels_par_ns\": " << m.pixelsParNs << "}" << (i + 1 < mesures.size() ? "," : "") << "\n";
+    }
+    fichier << "]\n";
+    return static_cast<bool>(fichier);
+}
+
+bool ecrireCsvEcarts(const std::string& chemin, const std::vector<Ecart>& ecarts) {
+    std::ofstream fichier(chemin.c_str());
+    fichier << "image,sigma,ecart_max,ecart_moyen\n";
+    for (size_t i = 0; i < ecarts.size(); ++i) {
+        fichier << ecarts[i].image << ',' << ecarts[i].sigma << ',' << ecarts[i].maximum << ','
+                << ecarts[i].moyenne << '\n';
+    }
+    return static_cast<bool>(fichier);
+}
+
+void afficherUsage() {
+    std::cerr << "Usage : bench_suite [--csv fichier] [--json fichier] [--precision fichier] [--repetitions n]"
+              << " [--tailles 1,4,16,64] [--sans-images] [--noyau nom]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string cheminCsv, cheminJson, cheminPrecision, filtreNoyau;
+    int repetitions = 11;
+    bool avecImages = true;
+    std::vector<int> taillesMpx = {1, 4, 16, 64};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--csv" && i + 1 < argc) {
+            cheminCsv = argv[++i];
+        } else if (option == "--json" && i + 1 < argc) {
+            cheminJson = argv[++i];
+        } else if (option == "--precision" && i + 1 < argc) {
+            cheminPrecision = argv[++i];
+        } else if (option == "--repetitions" && i + 1 < argc) {
+            repetitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (option == "--tailles" && i + 1 < argc) {
+            taillesMpx.clear();
+            std::stringstream liste(argv[++i]);
+            std::string taille;
+            while (std::getline(liste, taille, ',')) {
+                if (!taille.empty()) {
+                    taillesMpx.push_back(std::atoi(taille.c_str()));
+                }
+            }
+        } else if (option == "--sans-images") {
+            avecImages = false;
+        } else if (option == "--noyau" && i + 1 < argc) {
+            filtreNoyau = argv[++i];
+        } else {
+            afficherUsage();
+            return 1;
+        }
+    }
+
+    // Les images du dépôt, puis les images synthétiques (bruit uniforme, carrées)
+    std::vector<ImageBench> images;
+    if (avecImages) {
+        std::vector<std::string> chemins;
+        cv::glob("Images/*.png", chemins);
+        for (size_t i = 0; i < chemins.size(); ++i) {
+            cv::Mat image = cv::imread(chemins[i], cv::IMREAD_GRAYSCALE);
+            if (!image.empty()) {
+                ImageBench imageBench = {chemins[i], image};
+                images.push_back(imageBench);
+            }
+        }
+    }
+    for (size_t i = 0; i < taillesMpx.size(); ++i) {
+        int cote = static_cast<int>(std::sqrt(taillesMpx[i] * 1e6));
+        ImageBench imageBench = {"synthetique " + std::to_string(taillesMpx[i]) + "Mpx", cv::Mat(cote, cote, CV_8UC1)};
+        cv::randu(imageBench.image, cv::Scalar(0), cv::Scalar(256));
+        images.push_back(imageBench);
+    }
+
+    std::vector<Noyau> noyaux = noyauxBench();
+    std::vector<Mesure> mesures;
+    bool mesurerPrecisionGauss = false;
+
+    std::cout << std::left << std::setw(16) << "noyau" << std::setw(24) << "implementation" << std::setw(30) << "image"
+              << std::right << std::setw(12) << "mediane ms" << std::setw(12) << "p95 ms" << std::setw(10) << "px/ns"
+              << std::endl;
+
+    for (size_t n = 0; n < noyaux.size(); ++n) {
+        if (!filtreNoyau.empty() && noyaux[n].nom.find(filtreNoyau) == std::string::npos) {
+            continue;
+        }
+        if (noyaux[n].nom.compare(0, 11, "gauss sigma") == 0) {
+            mesurerPrecisionGauss = true;
+        }
+        for (size_t i = 0; i < images.size(); ++i) {
+            for (size_t k = 0; k < noyaux[n].implementations.size(); ++k) {
+                const Implementation& implementation = noyaux[n].implementations[k];
+                Mesure mesure;
+                mesure.noyau = noyaux[n].nom;
+                mesure.implementation = implementation.nom;
+                mesure.image = images[i].nom;
+                mesure.largeur = images[i].image.cols;
+                mesure.hauteur = images[i].image.rows;
+                mesurer(implementation.fonction, images[i].image, repetitions, mesure);
+                mesures.push_back(mesure);
+
+                std::cout << std::left << std::setw(16) << mesure.noyau << std::setw(24) << mesure.implementation
+                          << std::setw(30) << mesure.image << std::right << std::fixed << std::setprecision(3)
+                          << std::setw(12) << mesure.medianeMs << std::setw(12) << mesure.p95Ms
+                          << std::setw(10) << mesure.pixelsParNs << std::endl;
+            }
+        }
+    }
+
+    // Précision du flou récursif : il approche la gaussienne, il ne la reproduit pas
+    std::vector<Ecart> ecarts;
+    if (mesurerPrecisionGauss) {
+        std::cout << std::endl << std::left << std::setw(30) << "image" << std::right << std::setw(8) << "sigma"
+                  << std::setw(12) << "ecart max" << std::setw(14) << "ecart moyen" << std::endl;
+        for (size_t i = 0; i < images.size(); ++i) {
+            for (size_t k = 0; k < NB_SIGMAS_GAUSS; ++k) {
+                Ecart ecart = mesurerEcartGauss(images[i], SIGMAS_GAUSS[k]);
+                ecarts.push_back(ecart);
+                std::cout << std::left << std::setw(30) << ecart.image << std::right << std::fixed
+                          << std::setprecision(1) << std::setw(8) << ecart.sigma << std::setw(12) << ecart.maximum
+                          << std::setprecision(4) << std::setw(14) << ecart.moyenne << std::endl;
+            }
+        }
+    }
+
+    if (!cheminCsv.empty() && !ecrireCsv(cheminCsv, mesures)) {
+        std::cerr << "Impossible d'ecrire " << cheminCsv << std::endl;
+        return 1;
+    }
+    if (!cheminJson.empty() && !ecrireJson(cheminJson, mesures)) {
+        std::cerr << "Impossible d'ecrire " << cheminJson << std::endl;
+        return 1;
+    }
+    if (!cheminPrecision.empty() && !ecrireCsvEcarts(cheminPrecision, ecarts)) {
+        std::cerr << "Impossible d'ecrire " << cheminPrecision << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,473 @@
+#include <opencv2/opencv.hpp>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fonctions.hpp"
+
+// Traitement par lots, sans fenêtre : on lit toutes les images d'un dossier (ou d'un
+// motif), on leur applique une suite d'opérations et on écrit les résultats.
+// Lecture, calcul et écriture tournent dans des threads différents, reliés par des
+// files de taille bornée : pendant qu'une image est calculée, la suivante est déjà
+// en cours de décodage et la précédente en cours d'encodage.
+
+enum TypeOperation {
+    OP_HISTOGRAMME,
+    OP_ETIREMENT,
+    OP_SATURATION,
+    OP_EGALISATION,
+    OP_FLOU,
+    OP_GAUSS,
+    OP_MEDIAN,
+    OP_OTSU,
+    OP_SAUVOLA,
+    OP_COMPOSANTES,
+    OP_CONTOURS
+};
+
+struct Operation {
+    TypeOperation type;
+    int parametre1;
+    int parametre2;
+};
+
+// Une image qui traverse le pipeline
+struct Tache {
+    std::string chemin;
+    std::vector<uchar> fichier;   // contenu encodé, tel que lu sur le disque
+    cv::Mat image;
+    std::vector<std::vector<HistogrammeEntier<uint64_t> > > histogrammes;  // un histogramme par canal
+};
+
+// File bornée entre deux étages : pousser bloque quand la file est pleine, retirer
+// bloque quand elle est vide, et renvoie false une fois la file fermée et vidée.
+template<typename T>
+class FileBornee {
+public:
+    explicit FileBornee(size_t capacite) : capacite(capacite), fermee(false) {}
+
+    void pousser(T element) {
+        std::unique_lock<std::mutex> verrou(mutex);
+        nonPleine.wait(verrou, [this]() { return elements.size() < capacite; });
+        elements.push_back(std::move(element));
+        nonVide.notify_one();
+    }
+
+    bool retirer(T& element) {
+        std::unique_lock<std::mutex> verrou(mutex);
+        nonVide.wait(verrou, [this]() { return !elements.empty() || fermee; });
+        if (elements.empty()) {
+            return false;
+        }
+        element = std::move(elements.front());
+        elements.pop_front();
+        nonPleine.notify_one();
+        return true;
+    }
+
+    void fermer() {
+        std::lock_guard<std::mutex> verrou(mutex);
+        fermee = true;
+        nonVide.notify_all();
+    }
+
+private:
+    std::deque<T> elements;
+    size_t capacite;
+    bool fermee;
+    std::mutex mutex;
+    std::condition_variable nonVide;
+    std::condition_variable nonPleine;
+};
+
+void afficherUsage() {
+    std::cerr << "Usage : segbatch [-j threads] [-o dossier_sortie] [-t] <dossier|motif> <operation>..." << std::endl
+              << "  -t garde le type des images (couleur, 16 bits, flottant) au lieu de les lire en gris 8 bits"
+              << std::endl
+              << "Operations, appliquees dans l'ordre :" << std::endl
+              << "  histogramme          ecrit l'histogramme courant dans <image>.hist<i>.csv" << std::endl
+              << "  etirement[:min:max]  etire l'histogramme (toute la dynamique du type par defaut)" << std::endl
+              << "  saturation[:bas:haut] etire entre les centiles bas et haut (1 et 99 par defaut), images 8 bits"
+              << std::endl
+              << "  egalisation          egalise l'histogramme" << std::endl
+              << "  flou[:taille]        filtre moyenneur taille x taille (3 par defaut)" << std::endl
+              << "  gauss[:sigma]        flou gaussien recursif d'ecart type sigma pixels (8 par defaut)" << std::endl
+              << "  median[:taille]      filtre median taille x taille (3 par defaut), images 8 bits en gris"
+              << std::endl
+              << "  otsu[:classes]       seuillage d'Otsu en 2 a 4 classes (2 par defaut), images 8 bits en gris"
+              << std::endl
+              << "  sauvola[:taille]     seuillage adaptatif de Sauvola, fenetre taille x taille (31 par defaut),"
+              << " images 8 bits en gris" << std::endl
+              << "  composantes[:4|8]    une couleur par composante connexe (connexite 8 par defaut),"
+              << " images binaires 8 bits" << std::endl
+              << "  contours             laplacien 3x3, en valeur absolue" << std::endl;
+}
+
+bool lireOperation(const std::string& texte, Operation& operation) {
+    std::vector<std::string> morceaux;
+    size_t debut = 0;
+    for (size_t fin = texte.find(':'); ; fin = texte.find(':', debut)) {
+        morceaux.push_back(texte.substr(debut, fin - debut));
+        if (fin == std::string::npos) {
+            break;
+        }
+        debut = fin + 1;
+    }
+
+    const std::string& nom = morceaux[0];
+    if (nom == "histogramme" && morceaux.size() == 1) {
+        operation.type = OP_HISTOGRAMME;
+    } else if (nom == "etirement" && (morceaux.size() == 1 || morceaux.size() == 3)) {
+        operation.type = OP_ETIREMENT;
+        operation.parametre1 = morceaux.size() == 3 ? std::atoi(morceaux[1].c_str()) : 0;
+        // -1 : la valeur maximale du type de l'image, connue seulement au calcul
+        operation.parametre2 = morceaux.size() == 3 ? std::atoi(morceaux[2].c_str()) : -1;
+    } else if (nom == "saturation" && (morceaux.size() == 1 || morceaux.size() == 3)) {
+        operation.type = OP_SATURATION;
+        operation.parametre1 = morceaux.size() == 3 ? std::atoi(morceaux[1].c_str()) : 1;
+        operation.parametre2 = morceaux.size() == 3 ? std::atoi(morceaux[2].c_str()) : 99;
+        if (operation.parametre1 < 0 || operation.parametre1 >= operation.parametre2 || operation.parametre2 > 100) {
+            return false;
+        }
+    } else if (nom == "egalisation" && morceaux.size() == 1) {
+        operation.type = OP_EGALISATION;
+    } else if (nom == "flou" && morceaux.size() <= 2) {
+        operation.type = OP_FLOU;
+        operation.parametre1 = morceaux.size() == 2 ? std::atoi(morceaux[1].c_str()) : 3;
+        if (operation.parametre1 <= 0 || operation.parametre1 % 2 == 0) {
+            return false;
+        }
+    } else if (nom == "gauss" && morceaux.size() <= 2) {
+        operation.type = OP_GAUSS;
+        operation.parametre1 = morceaux.size() == 2 ? std::atoi(morceaux[1].c_str()) : 8;
+        if (operation.parametre1 <= 0) {
+            return false;
+        }
+    } else if (nom == "median" && morceaux.size() <= 2) {
+        operation.type = OP_MEDIAN;
+        operation.parametre1 = morceaux.size() == 2 ? std::atoi(morceaux[1].c_str()) : 3;
+        if (operation.parametre1 <= 0 || operation.parametre1 % 2 == 0) {
+            return false;
+        }
+    } else if (nom == "otsu" && morceaux.size() <= 2) {
+        operation.type = OP_OTSU;
+        operation.parametre1 = morceaux.size() == 2 ? std::atoi(morceaux[1].c_str()) : 2;
+        if (operation.parametre1 < 2 || operation.parametre1 > NB_CLASSES_OTSU_MAX) {
+            return false;
+        }
+    } else if (nom == "sauvola" && morceaux.size() <= 2) {
+        operation.type = OP_SAUVOLA;
+        operation.parametre1 = morceaux.size() == 2 ? std::atoi(morceaux[1].c_str()) : 31;
+        if (operation.parametre1 < 3 || operation.parametre1 % 2 == 0) {
+            return false;
+        }
+    } else if (nom == "composantes" && morceaux.size() <= 2) {
+        operation.type = OP_COMPOSANTES;
+        operation.parametre1 = morceaux.size() == 2 ? std::atoi(morceaux[1].c_str()) : 8;
+        if (operation.parametre1 != 4 && operation.parametre1 != 8) {
+            return false;
+        }
+    } else if (nom == "contours" && morceaux.size() == 1) {
+        operation.type = OP_CONTOURS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool estUneImage(const std::string& chemin) {
+    static const char* extensions[] = {".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff", ".pgm", ".ppm"};
+    size_t point = chemin.find_last_of('.');
+    if (point == std::string::npos) {
+        return false;
+    }
+    std::string extension = chemin.substr(point);
+    for (size_t i = 0; i < extension.size(); ++i) {
+        extension[i] = static_cast<char>(std::tolower(extension[i]));
+    }
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); ++i) {
+        if (extension == extensions[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string nomFichier(const std::string& chemin) {
+    size_t separateur = chemin.find_last_of('/');
+    return separateur == std::string::npos ? chemin : chemin.substr(separateur + 1);
+}
+
+bool lireFichier(const std::string& chemin, std::vector<uchar>& contenu) {
+    std::ifstream fichier(chemin.c_str(), std::ios::binary | std::ios::ate);
+    if (!fichier) {
+        return false;
+    }
+    contenu.resize(static_cast<size_t>(fichier.tellg()));
+    fichier.seekg(0);
+    return static_cast<bool>(fichier.read(reinterpret_cast<char*>(contenu.data()), contenu.size()));
+}
+
+void appliquerOperations(Tache& tache, const std::vector<Operation>& operations) {
+    for (size_t i = 0; i < operations.size(); ++i) {
+        const Operation& operation = operations[i];
+        switch (operation.type) {
+            case OP_HISTOGRAMME: {
+                std::vector<HistogrammeEntier<uint64_t> > hists;
+                calculerHistogrammeCanaux(tache.image, hists);
+                tache.histogrammes.push_back(hists);
+                break;
+            }
+            case OP_ETIREMENT: {
+                cv::Mat imageEtiree;
+                double newMax = operation.parametre2 >= 0 ? operation.parametre2 : valeurMaxProfondeur(tache.image.depth());
+                etirerHistogramme(tache.image, imageEtiree, operation.parametre1, newMax);
+                tache.image = imageEtiree;
+                break;
+            }
+            case OP_SATURATION: {
+                cv::Mat imageEtiree;
+                etirerHistogrammePercentiles(tache.image, imageEtiree, 0, 255,
+                                             operation.parametre1 / 100.0, operation.parametre2 / 100.0);
+                if (!imageEtiree.empty()) {
+                    tache.image = imageEtiree;
+                }
+                break;
+            }
+            case OP_EGALISATION:
+                egaliserHistogramme(tache.image, tache.image);
+                break;
+            case OP_FLOU: {
+                int taille = operation.parametre1;
+                cv::Mat filtreBlur(taille, taille, CV_64F, cv::Scalar(1.0 / (taille * taille)));
+                tache.image = appliquerFiltre(tache.image, filtreBlur);
+                break;
+            }
+            case OP_GAUSS:
+                tache.image = flouGaussienRecursif(tache.image, operation.parametre1);
+                break;
+            case OP_MEDIAN: {
+                cv::Mat imageMediane = filtreMedian(tache.image, operation.parametre1);
+                if (!imageMediane.empty()) {
+                    tache.image = imageMediane;
+                }
+                break;
+            }
+            case OP_OTSU: {
+                cv::Mat imageSeuillee;
+                if (segmenterOtsu(tache.image, imageSeuillee, operation.parametre1)) {
+                    tache.image = imageSeuillee;
+                }
+                break;
+            }
+            case OP_SAUVOLA: {
+                cv::Mat imageSeuillee;
+                seuillageAdaptatif(tache.image, imageSeuillee, OptionsSeuillage(SEUIL_SAUVOLA, operation.parametre1));
+                if (!imageSeuillee.empty()) {
+                    tache.image = imageSeuillee;
+                }
+                break;
+            }
+            case OP_COMPOSANTES: {
+                cv::Mat etiquettes;
+                etiqueterComposantes(tache.image, etiquettes, operation.parametre1);
+                if (!etiquettes.empty()) {
+                    tache.image = colorierEtiquettes(etiquettes);
+                }
+                break;
+            }
+            case OP_CONTOURS: {
+                cv::Mat filtreContours = (cv::Mat_<double>(3, 3) << -1, -1, -1, -1, 8, -1, -1, -1, -1);
+                OptionsFiltre options;
+                options.operation = SORTIE_VALEUR_ABSOLUE;
+                tache.image = appliquerFiltre(tache.image, filtreContours, options);
+                break;
+            }
+        }
+    }
+}
+
+// Une ligne par case ; une colonne par canal si l'image en a plusieurs
+bool ecrireHistogramme(const std::string& chemin, const std::vector<HistogrammeEntier<uint64_t> >& hists) {
+    std::ofstream fichier(chemin.c_str());
+    fichier << "intensite";
+    for (size_t c = 0; c < hists.size(); ++c) {
+        fichier << (hists.size() == 1 ? ",nombre" : ",canal" + std::to_string(c));
+    }
+    fichier << '\n';
+    for (int k = 0; !hists.empty() && k < hists[0].nbCases(); ++k) {
+        fichier << k;
+        for (size_t c = 0; c < hists.size(); ++c) {
+            fichier << ',' << hists[c][k];
+        }
+        fichier << '\n';
+    }
+    return static_cast<bool>(fichier);
+}
+
+int main(int argc, char** argv) {
+    int nbThreadsCalcul = nombreThreadsEffectif(0);
+    std::string dossierSortie = "sortie";
+    bool garderType = false;
+
+    int argument = 1;
+    for (; argument < argc && argv[argument][0] == '-'; ++argument) {
+        std::string option = argv[argument];
+        if (option == "-j" && argument + 1 < argc) {
+            nbThreadsCalcul = std::max(std::atoi(argv[++argument]), 1);
+        } else if (option == "-o" && argument + 1 < argc) {
+            dossierSortie = argv[++argument];
+        } else if (option == "-t") {
+            garderType = true;
+        } else {
+            afficherUsage();
+            return 1;
+        }
+    }
+    if (argc - argument < 2) {
+        afficherUsage();
+        return 1;
+    }
+
+    // Un dossier ou un motif (Images/*.png) ; cv::glob accepte les deux
+    std::vector<std::string> candidats, chemins;
+    cv::glob(argv[argument++], candidats, false);
+    for (size_t i = 0; i < candidats.size(); ++i) {
+        if (estUneImage(candidats[i])) {
+            chemins.push_back(candidats[i]);
+        }
+    }
+
+    std::vector<Operation> operations;
+    bool imageModifiee = false;
+    for (; argument < argc; ++argument) {
+        Operation operation;
+        if (!lireOperation(argv[argument], operation)) {
+            std::cerr << "Operation inconnue : " << argv[argument] << std::endl;
+            afficherUsage();
+            return 1;
+        }
+        imageModifiee = imageModifiee || operation.type != OP_HISTOGRAMME;
+        operations.push_back(operation);
+    }
+
+    if (chemins.empty()) {
+        std::cerr << "Aucune image a traiter." << std::endl;
+        return 1;
+    }
+    if (mkdir(dossierSortie.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Impossible de creer le dossier " << dossierSortie << std::endl;
+        return 1;
+    }
+
+    // Les images sont déjà traitées en parallèle : chaque noyau reste sur un seul coeur
+    definirNombreThreads(1);
+    int nbThreadsES = std::max(nbThreadsCalcul / 2, 1);
+
+    FileBornee<std::string> aLire(chemins.size());
+    FileBornee<Tache> aCalculer(2 * nbThreadsCalcul);
+    FileBornee<Tache> aEcrire(2 * nbThreadsCalcul);
+    for (size_t i = 0; i < chemins.size(); ++i) {
+        aLire.pousser(chemins[i]);
+    }
+    aLire.fermer();
+
+    std::atomic<uint64_t> octetsLus(0);
+    std::atomic<uint64_t> octetsPixels(0);
+    std::atomic<int> nbTraitees(0);
+    std::atomic<int> nbEchecs(0);
+
+    auto decoder = [&]() {
+        std::string chemin;
+        while (aLire.retirer(chemin)) {
+            Tache tache;
+            tache.chemin = chemin;
+            if (lireFichier(chemin, tache.fichier)) {
+                tache.image = cv::imdecode(tache.fichier, garderType ? cv::IMREAD_UNCHANGED : cv::IMREAD_GRAYSCALE);
+            }
+            if (tache.image.empty()) {
+                std::cerr << "Erreur de chargement de l'image " << chemin << std::endl;
+                ++nbEchecs;
+                continue;
+            }
+            octetsLus += tache.fichier.size();
+            octetsPixels += tache.image.total() * tache.image.elemSize();
+            tache.fichier.clear();
+            aCalculer.pousser(std::move(tache));
+        }
+    };
+
+    auto calculer = [&]() {
+        Tache tache;
+        while (aCalculer.retirer(tache)) {
+            appliquerOperations(tache, operations);
+            aEcrire.pousser(std::move(tache));
+        }
+    };
+
+    auto encoder = [&]() {
+        Tache tache;
+        while (aEcrire.retirer(tache)) {
+            std::string base = dossierSortie + "/" + nomFichier(tache.chemin);
+            bool reussi = true;
+            for (size_t i = 0; i < tache.histogrammes.size(); ++i) {
+                reussi = ecrireHistogramme(base + ".hist" + std::to_string(i) + ".csv", tache.histogrammes[i]) && reussi;
+            }
+            if (imageModifiee) {
+                reussi = cv::imwrite(base, tache.image) && reussi;
+            }
+            if (reussi) {
+                ++nbTraitees;
+            } else {
+                std::cerr << "Erreur d'ecriture pour " << tache.chemin << std::endl;
+                ++nbEchecs;
+            }
+        }
+    };
+
+    auto debut = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> decodeurs, calculateurs, encodeurs;
+    for (int t = 0; t < nbThreadsES; ++t) {
+        decodeurs.emplace_back(decoder);
+        encodeurs.emplace_back(encoder);
+    }
+    for (int t = 0; t < nbThreadsCalcul; ++t) {
+        calculateurs.emplace_back(calculer);
+    }
+
+    // Chaque étage ferme la file suivante quand tous ses threads ont fini
+    for (size_t t = 0; t < decodeurs.size(); ++t) {
+        decodeurs[t].join();
+    }
+    aCalculer.fermer();
+    for (size_t t = 0; t < calculateurs.size(); ++t) {
+        calculateurs[t].join();
+    }
+    aEcrire.fermer();
+    for (size_t t = 0; t < encodeurs.size(); ++t) {
+        encodeurs[t].join();
+    }
+
+    double secondes = std::chrono::duration<double>(std::chrono::steady_clock::now() - debut).count();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << nbTraitees << " image(s) traitee(s), " << nbEchecs << " echec(s) en " << secondes << " s" << std::endl
+              << "Debit : " << nbTraitees / secondes << " images/s, "
+              << octetsLus / secondes / 1e6 << " Mo/s lus sur le disque, "
+              << octetsPixels / secondes / 1e6 << " Mo/s de pixels" << std::endl;
+
+    return nbEchecs == 0 ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+#include "affichage.hpp"
+#include <cstdint>
+#include "contraste.hpp"
+#include "croissance.hpp"
+#include "etiquetage.hpp"
+#include "filtre.hpp"
+#include "histogramme.hpp"
+#include "partage.hpp"
+#include "seuillage.hpp"
+
+void normalizeHist(const cv::Mat& hist, cv::Mat& normalizedHist, int targetHeight) {
+    // Trouver la valeur maximale de l'histogramme pour l'échelle
+    double maxVal;
+    double minVal;
+
+    // On ne garde que la valeur maximal.
+    minMaxHist(hist, minVal, maxVal);
+
+    // On crée une matrice pour l'histogramme normalisé
+    normalizedHist = cv::Mat::zeros(1, hist.cols, CV_32F);
+
+    // On parcour l'histogramme
+    for (int i = 0; i < hist.cols; ++i) {
+        // Et on normalise chaque compartiment
+        normalizedHist.at<float>(0, i) = hist.at<float>(0, i) * targetHeight / maxVal;
+    }
+}
+
+void afficherHistogramme(const std::string titre, const cv::Mat& hist) {
+    // Dessiner l'histogramme
+    int histSize = hist.cols;
+    int hist_w = 512;
+    int hist_h = 400;
+    int bin_w = cvRound((double)hist_w / histSize);
+    cv::Mat histImage(hist_h, hist_w, CV_8UC3, cv::Scalar(255, 255, 255));
+
+    // Normaliser l'histogramme avec la fonction personnalisée
+    cv::Mat normalizedHist;
+    normalizeHist(hist, normalizedHist, hist_h);
+
+    // Dessiner les compartiments de l'histogramme normalisé
+    for (int i = 1; i < histSize; i++) {
+        cv::line(histImage, cv::Point(bin_w * (i - 1), hist_h - cvRound(normalizedHist.at<float>(0, i - 1))),
+                    cv::Point(bin_w * (i), hist_h - cvRound(normalizedHist.at<float>(0, i))),
+                    cv::Scalar(0, 0, 0), 2, 8, 0);
+    }
+
+    // Afficher l'histogramme
+    cv::imshow(titre, histImage);
+}
+
+void HistogrammeGrisOpenCV(cv::Mat & image) {
+    // Calculer l'histogramme de l'image
+    cv::Mat hist;
+    
+    // Utiliser le canal 0 (niveaux de gris) pour l'histogramme
+    int channels[] = {0}; 
+
+    // Nombre de compartiments dans l'histogramme
+    int bins = 256; 
+    int histSize[] = {bins};
+
+    // La plage de valeurs pour le niveau de gris
+    float range[] = {0, 256}; 
+    const float* ranges[] = {range};
+    cv::calcHist(&image, 1, channels, cv::Mat(), hist, 1, histSize, ranges, true, false);
+
+    // Dessiner l'histogramme
+    int hist_w = 512;
+    int hist_h = 400;
+    int bin_w = cvRound((double)hist_w / bins);
+    cv::Mat histImage(hist_h, hist_w, CV_8UC3, cv::Scalar(255, 255, 255));
+
+    // Normaliser l'histogramme pour qu'il rentre dans l'image
+    cv::normalize(hist, hist, 0, histImage.rows, cv::NORM_MINMAX, -1, cv::Mat());
+
+    // Dessiner les compartiments de l'histogramme
+    for (int i = 1; i < bins; i++) {
+        cv::line(histImage, cv::Point(bin_w * (i - 1), hist_h - cvRound(hist.at<float>(i - 1))),
+                    cv::Point(bin_w * (i), hist_h - cvRound(hist.at<float>(i))),
+                    cv::Scalar(0, 0, 0), 2, 8, 0);
+    }
+
+    // Afficher l'histogramme
+    cv::imshow("Histogramme Gris", histImage);
+}
+
+void comparaisonHist(cv::Mat& image, cv::Mat & hist) {
+     // On calcule l'histogramme de l'image avec openCV
+    HistogrammeGrisOpenCV(image);
+
+    // On cré nous même l'histogramme
+    // cv::Mat hist;
+    monCalcHist(image, hist);
+    // Et on l'affiche pour comparer avec open cv
+    afficherHistogramme("Histogramme fait nous meme", hist);
+}
+
+void comparasonEtirement(cv::Mat& image, cv::Mat& hist) {
+    // On calcule l'histogramme cumulé
+    cv::Mat histCumule;
+    calculerHistogrammeCumule(hist, histCumule);
+    // On affiche l'histogramme cumulé 
+    afficherHistogramme("Histogramme cumule", histCumule);
+
+
+    // On étire l'histogramme version claire ; les bornes de l'image sont lues dans son
+    // histogramme, déjà calculé
+    cv::Mat imageEtiree;
+    etirerHistogramme(image, imageEtiree, 200, 255, hist);
+    // On affiche l'image étirée : imshow affiche directement une image en niveaux de gris
+    cv::imshow("Image Etiree version claire", imageEtiree);
+
+    cv::Mat histEtiree;
+    // On calcule l'histogramme de l'image étirée
+    monCalcHist(imageEtiree, histEtiree);
+    // Et on l'affiche 
+    afficherHistogramme("Histogramme etire claire", histEtiree);
+
+
+    // On étire l'histogramme verison sombre
+    cv::Mat imageEtireev2;
+    etirerHistogramme(image, imageEtireev2, 10, 100, hist);
+    // On affiche l'image étirée
+    cv::imshow("Image Etiree version sombre", imageEtireev2);       
+    // On calcule l'histogramme de l'image étirée
+    monCalcHist(imageEtireev2, histEtiree);
+    // Et on l'affiche 
+    afficherHistogramme("Histogramme etire sombre", histEtiree);
+
+
+    // On étire toute la dynamique entre le 1er et le 99e centile, lus dans l'histogramme
+    // cumulé : les quelques pixels extrêmes sont saturés au lieu d'écraser le contraste
+    cv::Mat imageSaturee;
+    etirerHistogrammePercentiles(image, imageSaturee, 0, 255, histCumule, 0.01, 0.99);
+    cv::imshow("Image Etiree 1%-99%", imageSaturee);
+    monCalcHist(imageSaturee, histEtiree);
+    afficherHistogramme("Histogramme etire 1%-99%", histEtiree);
+}
+
+void comparaisonEgalisation(cv::Mat& image) {
+    cv::Mat imageEqualiseeOpenCV;
+    // On égalise l'histogramme avec openCV
+    egalizeHistOpenCV(image, imageEqualiseeOpenCV);
+    // On affiche l'image égalisée
+    cv::imshow("Image Egalise avec OpenCV", imageEqualiseeOpenCV);
+    
+    // On applique notre fonction d'égalisation
+    cv::Mat imageEgalisee;
+    egaliseHist(image, imageEgalisee);
+    // On affiche l'image égalisée
+    cv::imshow("Image Egalisee sans formule", imageEgalisee);
+
+
+    // On applique notre fonction d'égalisation avec la formule
+    cv::Mat imageEgaliseeFormule;
+    egalizeHistFormule(image, imageEgaliseeFormule);
+    // On affiche l'image égalisée
+    cv::imshow("Image Egalisee avec Formule", imageEgaliseeFormule);
+
+
+    // On égalise par tuiles avec un contraste limité (CLAHE) : le bruit des zones
+    // uniformes n'est plus amplifié comme par l'égalisation globale
+    cv::Mat imageClahe;
+    egaliserHistogrammeClahe(image, imageClahe, 2.0, 8, 8);
+    cv::imshow("Image Egalisee CLAHE", imageClahe);
+
+    cv::Mat imageClaheOpenCV;
+    cv::createCLAHE(2.0, cv::Size(8, 8))->apply(image, imageClaheOpenCV);
+    cv::imshow("Image Egalisee CLAHE avec OpenCV", imageClaheOpenCV);
+}
+
+void comparaisonConvolution(cv::Mat& image) {
+    // On applique un filtre de détection de contours
+        cv::Mat filtreContours = (cv::Mat_<double>(3, 3) << -1, -1, -1, -1, 8, -1, -1, -1, -1);
+        // On applique le filtre
+        cv::Mat imageContours = appliquerFiltre(image, filtreContours);
+        // On affiche l'image des contours
+        cv::imshow("Image Contours", imageContours);
+
+        // On applique un filtre de blur (noyeux) a taille reduite
+        cv::Mat filtreBlur = (cv::Mat_<double>(3, 3) << 1.0/9, 1.0/9, 1.0/9, 1.0/9, 1.0/9, 1.0/9, 1.0/9, 1.0/9, 1.0/9);
+        // On applique le filtre
+        cv::Mat imageMasque = appliquerFiltre(image, filtreBlur);
+        // On affiche l'image floutée
+        cv::imshow("Image filtre", imageMasque);
+
+        // On applique un filtre de blur (noyeux) a taille reduite d'oepncv
+        cv::Mat imageBlur;
+        cv::GaussianBlur(image, imageBlur, cv::Size(3, 3), 0);
+        // On affiche l'image floutée
+        cv::imshow("Image filtre OpenCV", imageBlur);
+
+        // On applique un flou gaussien récursif de grand écart type : son coût ne dépend
+        // pas de sigma, il sert à estimer le fond de l'image
+        cv::Mat imageFond = flouGaussienRecursif(image, 15.0);
+        // On affiche le fond estimé
+        cv::imshow("Image flou gaussien recursif", imageFond);
+
+        // On applique un filtre médian : le bruit poivre et sel disparaît sans que les
+        // contours soient étalés comme avec le flou
+        cv::Mat imageMediane = filtreMedian(image, 3);
+        // On affiche l'image débruitée
+        cv::imshow("Image filtre median", imageMediane);
+}
+
+cv::Mat colorierEtiquettes(const cv::Mat& etiquettes) {
+    cv::Mat couleurs(etiquettes.size(), CV_8UC3);
+    for (int y = 0; y < etiquettes.rows; ++y) {
+        const int* ligne = etiquettes.ptr<int>(y);
+        cv::Vec3b* sortie = couleurs.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < etiquettes.cols; ++x) {
+            // Un hachage multiplicatif : deux étiquettes voisines ont des couleurs éloignées
+            uint32_t h = static_cast<uint32_t>(ligne[x]) * 2654435761u;
+            sortie[x] = ligne[x] == 0 ? cv::Vec3b(0, 0, 0)
+                                      : cv::Vec3b(64 + (h >> 24) % 192, 64 + (h >> 16) % 192, 64 + (h >> 8) % 192);
+        }
+    }
+    return couleurs;
+}
+
+void comparaisonSeuillage(cv::Mat& image) {
+        // On cherche le seuil d'Otsu dans l'histogramme de l'image
+        std::vector<int> seuils;
+        cv::Mat imageOtsu;
+        segmenterOtsu(image, imageOtsu, 2, seuils);
+        // On affiche l'image seuillée
+        cv::imshow("Image Otsu", imageOtsu);
+
+        // On seuille avec OpenCV
+        cv::Mat imageOtsuOpenCV;
+        double seuilOpenCV = cv::threshold(image, imageOtsuOpenCV, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        // On affiche l'image seuillée par OpenCV
+        cv::imshow("Image Otsu OpenCV", imageOtsuOpenCV);
+        std::cout << "Seuil d'Otsu : " << seuils[0] << " (OpenCV : " << seuilOpenCV << ")" << std::endl;
+
+        // On sépare l'image en 4 classes avec 3 seuils
+        cv::Mat imageOtsu4;
+        segmenterOtsu(image, imageOtsu4, 4);
+        // On affiche les 4 classes
+        cv::imshow("Image Otsu 4 classes", imageOtsu4);
+
+        // On seuille chaque pixel selon sa fenêtre 31x31 : un éclairage inégal ne gêne plus
+        cv::Mat imageMoyenneLocale;
+        seuillageAdaptatif(image, imageMoyenneLocale, OptionsSeuillage(SEUIL_MOYENNE, 31));
+        // On affiche l'image seuillée
+        cv::imshow("Image seuil adaptatif", imageMoyenneLocale);
+
+        // On seuille avec OpenCV
+        cv::Mat imageMoyenneLocaleOpenCV;
+        cv::adaptiveThreshold(image, imageMoyenneLocaleOpenCV, 255, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY, 31, 5.0);
+        // On affiche l'image seuillée par OpenCV
+        cv::imshow("Image seuil adaptatif OpenCV", imageMoyenneLocaleOpenCV);
+
+        // On seuille avec la méthode de Sauvola
+        cv::Mat imageSauvola;
+        seuillageAdaptatif(image, imageSauvola, OptionsSeuillage(SEUIL_SAUVOLA, 31));
+        // On affiche l'image seuillée
+        cv::imshow("Image Sauvola", imageSauvola);
+
+        // On étiquette les composantes connexes de l'image seuillée par Otsu
+        cv::Mat etiquettes;
+        std::vector<Composante> composantes;
+        int nombre = etiqueterComposantes(imageOtsu, etiquettes, composantes, 8);
+        // On affiche une couleur par composante, avec sa boîte englobante
+        cv::Mat imageComposantes = colorierEtiquettes(etiquettes);
+        for (size_t i = 0; i < composantes.size(); ++i) {
+            cv::rectangle(imageComposantes, composantes[i].boite, cv::Scalar(255, 255, 255));
+        }
+        cv::imshow("Image composantes", imageComposantes);
+
+        // On compte avec OpenCV, qui compte aussi le fond
+        cv::Mat etiquettesOpenCV;
+        int nombreOpenCV = cv::connectedComponents(imageOtsu, etiquettesOpenCV, 8) - 1;
+        std::cout << "Composantes connexes : " << nombre << " (OpenCV : " << nombreOpenCV << ")" << std::endl;
+}
+
+void comparaisonSegmentation(cv::Mat& image) {
+        // On place 9 germes en grille, chacun fait croître sa région en même temps que les autres
+        std::vector<cv::Point> germes;
+        for (int i = 1; i <= 3; ++i) {
+            for (int j = 1; j <= 3; ++j) {
+                germes.push_back(cv::Point(j * image.cols / 4, i * image.rows / 4));
+            }
+        }
+        cv::Mat regions;
+        croissanceRegions(image, germes, regions);
+        // On affiche une couleur par région, les pixels non atteints en noir
+        cv::imshow("Image croissance de regions", colorierEtiquettes(regions));
+
+        // On prend comme relief la norme du gradient de Sobel
+        cv::Mat relief = gradientSobel(image);
+        // On garde comme marqueurs les zones plates de l'image seuillée par Otsu, côté objets
+        // comme côté fond
+        cv::Mat binaire;
+        segmenterOtsu(image, binaire);
+        cv::Mat objets = cv::Mat::zeros(image.size(), CV_8UC1);
+        cv::Mat fond = cv::Mat::zeros(image.size(), CV_8UC1);
+        for (int y = 0; y < image.rows; ++y) {
+            for (int x = 0; x < image.cols; ++x) {
+                if (relief.at<uchar>(y, x) <= 32) {
+                    (binaire.at<uchar>(y, x) != 0 ? objets : fond).at<uchar>(y, x) = 255;
+                }
+            }
+        }
+        cv::Mat etiquettesObjets, etiquettesFond;
+        std::vector<Composante> composantesObjets, composantesFond;
+        etiqueterComposantes(objets, etiquettesObjets, composantesObjets, 4);
+        etiqueterComposantes(fond, etiquettesFond, composantesFond, 4);
+
+        // On numérote à la suite les composantes d'au moins 50 pixels, objets puis fond
+        int nbMarqueurs = 0;
+        std::vector<int> numerosObjets(composantesObjets.size() + 1, 0), numerosFond(composantesFond.size() + 1, 0);
+        for (size_t i = 0; i < composantesObjets.size(); ++i) {
+            if (composantesObjets[i].aire >= 50) {
+                numerosObjets[i + 1] = ++nbMarqueurs;
+            }
+        }
+        for (size_t i = 0; i < composantesFond.size(); ++i) {
+            if (composantesFond[i].aire >= 50) {
+                numerosFond[i + 1] = ++nbMarqueurs;
+            }
+        }
+        cv::Mat marqueurs(image.size(), CV_32S);
+        for (int y = 0; y < image.rows; ++y) {
+            for (int x = 0; x < image.cols; ++x) {
+                marqueurs.at<int>(y, x) = numerosObjets[etiquettesObjets.at<int>(y, x)]
+                                          + numerosFond[etiquettesFond.at<int>(y, x)];
+            }
+        }
+
+        // On inonde le relief depuis les marqueurs, une couleur par bassin
+        ligneDePartageEaux(relief, marqueurs);
+        cv::imshow("Image ligne de partage des eaux", colorierEtiquettes(marqueurs));
+        std::cout << "Ligne de partage des eaux : " << nbMarqueurs << " bassins" << std::endl;
+}
@@ -0,0 +1,32 @@
+#ifndef SEGIMG_AFFICHAGE_HPP
+#define SEGIMG_AFFICHAGE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Met l'histogramme à l'échelle pour que son maximum vaille targetHeight
+void normalizeHist(const cv::Mat& hist, cv::Mat& normalizedHist, int targetHeight);
+
+// Dessine et affiche un histogramme dans une fenêtre
+void afficherHistogramme(const std::string titre, const cv::Mat& hist);
+
+// Calcule l'histogramme avec OpenCV et l'affiche
+void HistogrammeGrisOpenCV(cv::Mat & image);
+
+// Une couleur par étiquette d'une image CV_32S (etiqueterComposantes), le fond en noir
+cv::Mat colorierEtiquettes(const cv::Mat& etiquettes);
+
+// Les comparaisons visuelles avec OpenCV de tp0
+void comparaisonHist(cv::Mat& image, cv::Mat & hist);
+
+void comparasonEtirement(cv::Mat& image, cv::Mat& hist);
+
+void comparaisonEgalisation(cv::Mat& image);
+
+void comparaisonConvolution(cv::Mat& image);
+
+void comparaisonSeuillage(cv::Mat& image);
+
+void comparaisonSegmentation(cv::Mat& image);
+
+#endif
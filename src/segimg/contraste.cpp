@@ -0,0 +1,505 @@
+#include "contraste.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "histogramme.hpp"
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+void egalizeHistOpenCV(const cv::Mat& image, cv::Mat& newImage) {
+    // On applique la fonction d'égalisation d'histogramme d'openCV
+    cv::equalizeHist(image, newImage);
+}
+
+// Égalisation fusionnée : histogramme en compteurs entiers, cumul entier, table de
+// correspondance de 256 valeurs sur la pile, puis un seul passage sur les lignes pour
+// appliquer la table. Aucune matrice intermédiaire n'est créée : seule newImage est
+// allouée, et seulement si elle n'a pas déjà la bonne taille. On peut donc passer la
+// même matrice en entrée et en sortie pour égaliser l'image en place.
+void egaliserHistogrammeFusion(const cv::Mat& image, cv::Mat& newImage) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "L'égalisation attend une image en niveaux de gris 8 bits." << std::endl;
+        return;
+    }
+    // Une image vide n'a pas de pixel pour normaliser le cumul
+    if (image.empty()) {
+        newImage.create(image.size(), CV_8UC1);
+        return;
+    }
+
+    // On calcule l'histogramme de l'image
+    uint32_t histo[256];
+    calculerHistogrammeBrutParallele(image, histo, nombreThreadsParDefaut());
+
+    // On calcule l'histogramme cumulé et la transformation en arithmétique entière :
+    // nouvelle intensité = 255 * cumul / nombre de pixels, arrondie vers le bas
+    uint64_t totalPixels = static_cast<uint64_t>(image.rows) * image.cols;
+    uchar transformation[256];
+    uint64_t cumul = 0;
+    for (int k = 0; k < 256; ++k) {
+        cumul += histo[k];
+        transformation[k] = static_cast<uchar>(cumul * 255 / totalPixels);
+    }
+
+    // On applique la transformation ligne par ligne
+    newImage.create(image.size(), CV_8UC1);
+    int nbLignes = image.rows;
+    int nbColonnes = image.cols;
+    if (image.isContinuous() && newImage.isContinuous()) {
+        nbColonnes *= nbLignes;
+        nbLignes = 1;
+    }
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const uchar* source = image.ptr<uchar>(i);
+        uchar* destination = newImage.ptr<uchar>(i);
+        for (int j = 0; j < nbColonnes; ++j) {
+            destination[j] = transformation[source[j]];
+        }
+    }
+}
+
+void egaliseHist(const cv::Mat& image, cv::Mat& newImage) {
+    // La transformation 255 * cumul / nombre de pixels est celle du noyau fusionné
+    egaliserHistogrammeFusion(image, newImage);
+}
+
+void egalizeHistFormule(const cv::Mat& image, cv::Mat& resultat) {
+    // La formule vue en cours (dynamique 255 * histogramme cumulé / nombre de pixels)
+    // est appliquée par le noyau fusionné
+    egaliserHistogrammeFusion(image, resultat);
+}
+
+// Égalisation de chaque canal pour un type de pixel donné : histogramme par canal, puis
+// une table par canal qui donne la nouvelle valeur de chaque case. Les images 16 bits
+// passent par egaliserHistogramme16.
+struct EgalisationCanaux {
+    const cv::Mat& image;
+    cv::Mat& resultat;
+
+    template<typename T, int Canaux>
+    void appliquer() {
+        const int nbBins = 256;
+        double valeurMax = TraitsPixel<T>::valeurMax();
+        std::vector<HistogrammeEntier<uint64_t> > hists;
+        calculerHistogrammeCanaux(image, hists, nbBins, 0.0, TraitsPixel<T>::borneHistogramme());
+
+        // nouvelle valeur = valeurMax * cumul / nombre de pixels, arrondie vers le bas
+        // pour un type entier, comme dans egaliserHistogrammeFusion
+        uint64_t totalPixels = static_cast<uint64_t>(image.rows) * image.cols;
+        std::vector<T> tables(Canaux * nbBins);
+        for (int c = 0; c < Canaux; ++c) {
+            HistogrammeEntier<uint64_t> cumul;
+            hists[c].cumuler(cumul);
+            for (int k = 0; k < nbBins; ++k) {
+                if (std::numeric_limits<T>::is_integer) {
+                    tables[c * nbBins + k] = static_cast<T>(cumul[k] * static_cast<uint64_t>(valeurMax) / totalPixels);
+                } else {
+                    tables[c * nbBins + k] = static_cast<T>(valeurMax * cumul[k] / totalPixels);
+                }
+            }
+        }
+
+        resultat.create(image.size(), image.type());
+        if (std::numeric_limits<T>::is_integer) {
+            appliquerTableCanaux<T, Canaux>(image, resultat, &tables[0], nbBins, IndexeurDecalage(0));
+        } else {
+            // Les valeurs flottantes hors de [0, 1] prennent la première ou la dernière case
+            appliquerTableCanaux<T, Canaux>(image, resultat, &tables[0], nbBins,
+                                            IndexeurAffine<true>(nbBins, 0.0, TraitsPixel<T>::borneHistogramme()));
+        }
+    }
+};
+
+// Table d'égalisation d'un canal 16 bits, rangée comme hist.compteurs :
+// nouvelle valeur = 65535 * cumul / nombre de pixels, arrondie vers le bas
+template<typename Cumul>
+static void tableEgalisation16(const Histogramme16& hist, std::vector<ushort>& table) {
+    std::vector<Cumul> cumul;
+    calculerHistogrammeCumule16(hist, cumul);
+    table.resize(cumul.size());
+    for (size_t k = 0; k < cumul.size(); ++k) {
+        table[k] = static_cast<ushort>(static_cast<uint64_t>(cumul[k]) * 65535 / hist.total);
+    }
+}
+
+void egaliserHistogramme16(const cv::Mat& image, cv::Mat& resultat, int decalage) {
+    int nbCanaux = image.channels();
+    if (image.depth() != CV_16U || nbCanaux > 4) {
+        std::cerr << "L'égalisation 16 bits attend une image CV_16U de 1 à 4 canaux." << std::endl;
+        return;
+    }
+
+    // Chaque canal est compté avant d'être réécrit : on peut égaliser en place
+    resultat.create(image.size(), image.type());
+    Histogramme16 hist;
+    std::vector<ushort> table;
+    for (int c = 0; c < nbCanaux; ++c) {
+        calculerHistogramme16(image, hist, decalage, c);
+        if (hist.total == 0) {
+            return;
+        }
+        if (hist.total <= std::numeric_limits<uint32_t>::max()) {
+            tableEgalisation16<uint32_t>(hist, table);
+        } else {
+            tableEgalisation16<uint64_t>(hist, table);
+        }
+
+        switch (nbCanaux) {
+            case 1: appliquerTable16<1>(image, resultat, c, decalage, hist.blocs, &table[0]); break;
+            case 2: appliquerTable16<2>(image, resultat, c, decalage, hist.blocs, &table[0]); break;
+            case 3: appliquerTable16<3>(image, resultat, c, decalage, hist.blocs, &table[0]); break;
+            default: appliquerTable16<4>(image, resultat, c, decalage, hist.blocs, &table[0]); break;
+        }
+    }
+}
+
+void egaliserHistogramme(const cv::Mat& image, cv::Mat& resultat) {
+    if (image.type() == CV_8UC1) {
+        egaliserHistogrammeFusion(image, resultat);
+        return;
+    }
+    if (image.depth() == CV_16U) {
+        egaliserHistogramme16(image, resultat);
+        return;
+    }
+    EgalisationCanaux egalisation = {image, resultat};
+    if (!repartirSelonType(image.type(), egalisation)) {
+        std::cerr << "L'égalisation s'applique aux images 8U, 16U ou 32F de 1, 3 ou 4 canaux." << std::endl;
+    }
+}
+
+// En dessous, on ne lance pas de threads pour le CLAHE : le travail ne les paierait pas
+static const size_t SEUIL_CLAHE_PARALLELE = 1 << 18;
+
+// Table d'une tuile : l'histogramme est écrêté à `limite` (0 = pas d'écrêtage), ce qui
+// dépasse est réparti sur toutes les cases, le reste une case sur `pas`, puis le
+// cumul est ramené sur [0, 255]. Mêmes étapes et mêmes arrondis que cv::createCLAHE.
+static void tableTuileClahe(uint32_t histo[256], uint32_t limite, float echelle, uchar table[256]) {
+    if (limite > 0) {
+        uint32_t excedent = 0;
+        for (int k = 0; k < 256; ++k) {
+            if (histo[k] > limite) {
+                excedent += histo[k] - limite;
+                histo[k] = limite;
+            }
+        }
+
+        uint32_t parCase = excedent / 256;
+        uint32_t reste = excedent - parCase * 256;
+        for (int k = 0; k < 256; ++k) {
+            histo[k] += parCase;
+        }
+        if (reste > 0) {
+            int pas = std::max(256 / static_cast<int>(reste), 1);
+            for (int k = 0; k < 256 && reste > 0; k += pas, --reste) {
+                ++histo[k];
+            }
+        }
+    }
+
+    uint32_t somme = 0;
+    for (int k = 0; k < 256; ++k) {
+        somme += histo[k];
+        table[k] = cv::saturate_cast<uchar>(somme * echelle);
+    }
+}
+
+void egaliserHistogrammeClahe(const cv::Mat& image, cv::Mat& resultat, double limiteContraste, int tuilesX,
+                              int tuilesY, int nombreThreads) {
+    if (image.type() != CV_8UC1 || image.empty()) {
+        std::cerr << "Le CLAHE attend une image en niveaux de gris 8 bits." << std::endl;
+        return;
+    }
+    if (tuilesX <= 0 || tuilesY <= 0 || limiteContraste < 0.0) {
+        std::cerr << "Le CLAHE attend au moins une tuile dans chaque direction et une limite positive." << std::endl;
+        return;
+    }
+
+    // Comme OpenCV, si l'image ne se découpe pas exactement, on la prolonge en bas et à
+    // droite (par reflet) jusqu'à un multiple du nombre de tuiles
+    int largeurEtendue = image.cols;
+    int hauteurEtendue = image.rows;
+    if (image.cols % tuilesX != 0 || image.rows % tuilesY != 0) {
+        largeurEtendue += tuilesX - image.cols % tuilesX;
+        hauteurEtendue += tuilesY - image.rows % tuilesY;
+    }
+    int largeurTuile = largeurEtendue / tuilesX;
+    int hauteurTuile = hauteurEtendue / tuilesY;
+    int pixelsTuile = largeurTuile * hauteurTuile;
+
+    uint32_t limite = 0;
+    if (limiteContraste > 0.0) {
+        limite = std::max(static_cast<uint32_t>(limiteContraste * pixelsTuile / 256), 1u);
+    }
+    float echelle = 255.0f / pixelsTuile;
+
+    if (image.total() < SEUIL_CLAHE_PARALLELE) {
+        nombreThreads = 1;
+    }
+
+    // Une table de 256 valeurs par tuile, rangées ligne de tuiles par ligne de tuiles
+    std::vector<uchar> tables(tuilesX * tuilesY * 256);
+    executerEnParallele(tuilesX * tuilesY, nombreThreads, [&](int tuile) {
+        int x0 = (tuile % tuilesX) * largeurTuile;
+        int y0 = (tuile / tuilesX) * hauteurTuile;
+        int x1 = x0 + largeurTuile;
+        int y1 = y0 + hauteurTuile;
+
+        // La partie dans l'image passe par le noyau de monCalcHist ; seules les tuiles du
+        // bord comptent en plus, un par un, les pixels reflétés
+        uint32_t histo[256];
+        int largeurDedans = std::min(x1, image.cols) - x0;
+        int hauteurDedans = std::min(y1, image.rows) - y0;
+        if (largeurDedans > 0 && hauteurDedans > 0) {
+            calculerHistogrammeBrut(image(cv::Rect(x0, y0, largeurDedans, hauteurDedans)), histo);
+        } else {
+            std::fill(histo, histo + 256, 0u);
+        }
+        for (int y = y0; y < y1; ++y) {
+            const uchar* ligne = image.ptr<uchar>(indiceBord(y, image.rows, BORD_REFLET_101));
+            int debut = y < image.rows ? std::max(x0, image.cols) : x0;
+            for (int x = debut; x < x1; ++x) {
+                ++histo[ligne[indiceBord(x, image.cols, BORD_REFLET_101)]];
+            }
+        }
+
+        tableTuileClahe(histo, limite, echelle, &tables[tuile * 256]);
+    });
+
+    // Pour chaque colonne : les deux tuiles dont les centres l'encadrent et son poids
+    // entre les deux, calculés une fois pour toutes les lignes
+    std::vector<int> indiceGauche(image.cols), indiceDroite(image.cols);
+    std::vector<float> poidsDroite(image.cols), poidsGauche(image.cols);
+    float inverseLargeur = 1.0f / largeurTuile;
+    for (int x = 0; x < image.cols; ++x) {
+        float position = x * inverseLargeur - 0.5f;
+        int gauche = cvFloor(position);
+        poidsDroite[x] = position - gauche;
+        poidsGauche[x] = 1.0f - poidsDroite[x];
+        indiceGauche[x] = std::max(gauche, 0) * 256;
+        indiceDroite[x] = std::min(gauche + 1, tuilesX - 1) * 256;
+    }
+
+    // Chaque pixel interpole bilinéairement les tables des quatre tuiles voisines ; les
+    // bandes de lignes sont indépendantes
+    cv::Mat sortie(image.size(), CV_8UC1);
+    float inverseHauteur = 1.0f / hauteurTuile;
+    int nbBandes = std::min(image.rows, 4 * nombreThreadsEffectif(nombreThreads));
+    executerEnParallele(nbBandes, nombreThreads, [&](int bande) {
+        int debut = image.rows * bande / nbBandes;
+        int fin = image.rows * (bande + 1) / nbBandes;
+        for (int y = debut; y < fin; ++y) {
+            float position = y * inverseHauteur - 0.5f;
+            int haut = cvFloor(position);
+            float poidsBas = position - haut;
+            float poidsHaut = 1.0f - poidsBas;
+            const uchar* tablesHaut = &tables[std::max(haut, 0) * tuilesX * 256];
+            const uchar* tablesBas = &tables[std::min(haut + 1, tuilesY - 1) * tuilesX * 256];
+
+            const uchar* source = image.ptr<uchar>(y);
+            uchar* destination = sortie.ptr<uchar>(y);
+            for (int x = 0; x < image.cols; ++x) {
+                int v = source[x];
+                float valeur = (tablesHaut[indiceGauche[x] + v] * poidsGauche[x]
+                                + tablesHaut[indiceDroite[x] + v] * poidsDroite[x]) * poidsHaut
+                               + (tablesBas[indiceGauche[x] + v] * poidsGauche[x]
+                                  + tablesBas[indiceDroite[x] + v] * poidsDroite[x]) * poidsBas;
+                destination[x] = cv::saturate_cast<uchar>(valeur);
+            }
+        }
+    });
+    resultat = sortie;
+}
+
+void egaliserHistogrammeClahe(const cv::Mat& image, cv::Mat& resultat, double limiteContraste, int tuilesX,
+                              int tuilesY) {
+    egaliserHistogrammeClahe(image, resultat, limiteContraste, tuilesX, tuilesY, nombreThreadsParDefaut());
+}
+
+// Conversion d'une valeur étirée vers le type de l'image : les types entiers sont
+// tronqués comme dans la version d'origine, puis saturés
+template<typename T>
+static T convertirEtirement(double valeur) {
+    return std::numeric_limits<T>::is_integer ? cv::saturate_cast<T>(static_cast<int>(valeur)) : static_cast<T>(valeur);
+}
+
+// Étirement de chaque canal entre son minimum et son maximum. Les bornes viennent d'un
+// histogramme déjà calculé s'il y en a un, sinon d'une réduction min/max vectorisée.
+// Pour un type entier, on calcule une fois la nouvelle valeur de chaque intensité dans
+// une table, et l'image n'est plus parcourue qu'une fois, sans aucun calcul flottant.
+struct EtirementCanaux {
+    const cv::Mat& image;
+    cv::Mat& imageEtiree;
+    double newMin;
+    double newMax;
+    const double* bornesMin;  // bornes déjà connues, ou null
+    const double* bornesMax;
+
+    template<typename T, int Canaux>
+    void appliquer() {
+        // On trouve les valeurs minimales et maximales de chaque canal
+        double minVal[Canaux], maxVal[Canaux];
+        if (bornesMin != 0) {
+            std::copy(bornesMin, bornesMin + Canaux, minVal);
+            std::copy(bornesMax, bornesMax + Canaux, maxVal);
+        } else {
+            minMaxCanaux<T, Canaux>(image, minVal, maxVal);
+        }
+
+        // On calcule l'écart entre les valeurs minimales et maximales dans l'image de sortie
+        double newRange = newMax - newMin;
+
+        imageEtiree.create(image.size(), image.type());
+
+        if (std::numeric_limits<T>::is_integer) {
+            // Une table par canal, indexée directement par l'intensité : 256 entrées en 8
+            // bits, jusqu'à la plus grande valeur possible en 16 bits. Chaque entrée est
+            // calculée avec la formule vue en classe ; un canal constant prend la valeur
+            // newMin. Des bornes données peuvent laisser des pixels en dehors : ils sont
+            // saturés à newMin ou newMax.
+            int nbEntrees = TraitsPixel<T>::profondeur == CV_8U ? 256 : 1;
+            for (int c = 0; c < Canaux; ++c) {
+                nbEntrees = std::max(nbEntrees, static_cast<int>(maxVal[c]) + 1);
+            }
+            if (bornesMin != 0) {
+                nbEntrees = static_cast<int>(TraitsPixel<T>::valeurMax()) + 1;
+            }
+            std::vector<T> tables(Canaux * nbEntrees);
+            for (int c = 0; c < Canaux; ++c) {
+                double ecart = maxVal[c] - minVal[c];
+                for (int v = 0; v < nbEntrees; ++v) {
+                    double valeur = newMin;
+                    if (v > maxVal[c]) {
+                        valeur = newMax;
+                    } else if (v >= minVal[c] && ecart > 0.0) {
+                        valeur = newRange * (v - minVal[c]) / ecart + newMin;
+                    }
+                    tables[c * nbEntrees + v] = convertirEtirement<T>(valeur);
+                }
+            }
+            appliquerTableCanaux<T, Canaux>(image, imageEtiree, &tables[0], nbEntrees, IndexeurDecalage(0));
+            return;
+        }
+
+        // En flottant, la division est remplacée par un facteur calculé une fois par canal
+        // (les bornes données ne concernent que les images 8 bits)
+        double facteur[Canaux], decalage[Canaux];
+        for (int c = 0; c < Canaux; ++c) {
+            double ecart = maxVal[c] - minVal[c];
+            facteur[c] = ecart > 0.0 ? newRange / ecart : 0.0;
+            decalage[c] = newMin - facteur[c] * minVal[c];
+        }
+
+        int nbLignes, nbValeurs;
+        dimensionsParcours(image, imageEtiree, nbLignes, nbValeurs);
+        for (int i = 0; i < nbLignes; ++i) {
+            const T* source = image.ptr<T>(i);
+            T* destination = imageEtiree.ptr<T>(i);
+            for (int j = 0; j < nbValeurs; j += Canaux) {
+                for (int c = 0; c < Canaux; ++c) {
+                    destination[j + c] = static_cast<T>(facteur[c] * source[j + c] + decalage[c]);
+                }
+            }
+        }
+    }
+};
+
+static void etirer(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax,
+                   const double* bornesMin, const double* bornesMax) {
+    // On écrit dans une nouvelle image, pour que image et imageEtiree puissent être la même
+    cv::Mat resultat;
+    EtirementCanaux etirement = {image, resultat, newMin, newMax, bornesMin, bornesMax};
+    if (!repartirSelonType(image.type(), etirement)) {
+        std::cerr << "L'étirement s'applique aux images 8U, 16U ou 32F de 1, 3 ou 4 canaux." << std::endl;
+        return;
+    }
+    imageEtiree = resultat;
+}
+
+void etirerHistogramme(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax) {
+    etirer(image, imageEtiree, newMin, newMax, 0, 0);
+}
+
+void etirerHistogramme(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax, const cv::Mat& hist) {
+    if (image.depth() != CV_8U || hist.rows != image.channels() || hist.cols != 256 || hist.type() != CV_32F) {
+        std::cerr << "L'étirement attend l'histogramme 256 cases de chaque canal de l'image 8 bits." << std::endl;
+        return;
+    }
+
+    // Les bornes de chaque canal sont ses premières et dernières cases non vides
+    std::vector<double> minVal(hist.rows, 0.0), maxVal(hist.rows, 0.0);
+    for (int c = 0; c < hist.rows; ++c) {
+        const float* bins = hist.ptr<float>(c);
+        int premier = 0;
+        int dernier = 255;
+        while (premier < 255 && bins[premier] == 0.0f) {
+            ++premier;
+        }
+        while (dernier > premier && bins[dernier] == 0.0f) {
+            --dernier;
+        }
+        minVal[c] = premier;
+        maxVal[c] = dernier;
+    }
+    etirer(image, imageEtiree, newMin, newMax, &minVal[0], &maxVal[0]);
+}
+
+void bornesPercentiles(const cv::Mat& histCumule, int canal, double percentileBas, double percentileHaut,
+                       double& minVal, double& maxVal) {
+    const float* cumul = histCumule.ptr<float>(canal);
+    int nbCases = histCumule.cols;
+    double total = cumul[nbCases - 1];
+
+    // Borne basse : première intensité dont le cumul dépasse percentileBas du total ;
+    // borne haute : première intensité dont le cumul atteint percentileHaut du total
+    int bas = 0;
+    while (bas < nbCases - 1 && cumul[bas] <= percentileBas * total) {
+        ++bas;
+    }
+    int haut = bas;
+    while (haut < nbCases - 1 && cumul[haut] < percentileHaut * total) {
+        ++haut;
+    }
+    minVal = bas;
+    maxVal = haut;
+}
+
+void etirerHistogrammePercentiles(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax,
+                                  const cv::Mat& histCumule, double percentileBas, double percentileHaut) {
+    if (image.depth() != CV_8U || histCumule.rows != image.channels() || histCumule.cols != 256
+        || histCumule.type() != CV_32F) {
+        std::cerr << "L'étirement attend l'histogramme cumulé 256 cases de chaque canal de l'image 8 bits." << std::endl;
+        return;
+    }
+    if (!(percentileBas >= 0.0 && percentileBas < percentileHaut && percentileHaut <= 1.0)) {
+        std::cerr << "Les percentiles doivent vérifier 0 <= bas < haut <= 1." << std::endl;
+        return;
+    }
+
+    // Les bornes sont lues dans le cumul : aucun parcours de l'image en plus de la table
+    std::vector<double> minVal(histCumule.rows, 0.0), maxVal(histCumule.rows, 0.0);
+    for (int c = 0; c < histCumule.rows; ++c) {
+        bornesPercentiles(histCumule, c, percentileBas, percentileHaut, minVal[c], maxVal[c]);
+    }
+    etirer(image, imageEtiree, newMin, newMax, &minVal[0], &maxVal[0]);
+}
+
+void etirerHistogrammePercentiles(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax,
+                                  double percentileBas, double percentileHaut) {
+    // Le parcours de l'histogramme remplace celui du min/max
+    cv::Mat histCumule;
+    calculerHistogrammeCanaux(image, histCumule);
+    if (histCumule.empty()) {
+        return;
+    }
+    for (int c = 0; c < histCumule.rows; ++c) {
+        cv::Mat ligne = histCumule.row(c);
+        cv::Mat cumul;
+        calculerHistogrammeCumule(ligne, cumul);
+        cumul.copyTo(ligne);
+    }
+    etirerHistogrammePercentiles(image, imageEtiree, newMin, newMax, histCumule, percentileBas, percentileHaut);
+}
@@ -0,0 +1,66 @@
+#ifndef SEGIMG_CONTRASTE_HPP
+#define SEGIMG_CONTRASTE_HPP
+
+#include <opencv2/opencv.hpp>
+
+// Égalisation d'histogramme par OpenCV, pour comparer
+void egalizeHistOpenCV(const cv::Mat& image, cv::Mat& newImage);
+
+// Égalisation en un seul noyau (histogramme, cumul et table entiers) ; image et
+// newImage peuvent être la même matrice pour égaliser en place
+void egaliserHistogrammeFusion(const cv::Mat& image, cv::Mat& newImage);
+
+void egaliseHist(const cv::Mat& image, cv::Mat& newImage);
+
+void egalizeHistFormule(const cv::Mat& image, cv::Mat& resultat);
+
+// Égalise chaque canal d'une image CV_16U sans la ramener à 8 bits : 65536 cases par
+// défaut, ou des cases de 2^decalage valeurs (decalage de 0 à 8). L'histogramme, le
+// cumul et la table sont entiers et rangés en deux niveaux (voir Histogramme16).
+void egaliserHistogramme16(const cv::Mat& image, cv::Mat& resultat, int decalage = 0);
+
+// Égalise chaque canal d'une image 8U, 16U ou 32F à 1, 3 ou 4 canaux : 256 cases en 8
+// bits et en flottant (image supposée dans [0, 1]), 65536 cases en 16 bits
+void egaliserHistogramme(const cv::Mat& image, cv::Mat& resultat);
+
+// CLAHE (égalisation adaptative à contraste limité) d'une image 8 bits en niveaux de
+// gris, comme cv::createCLAHE(limiteContraste, cv::Size(tuilesX, tuilesY))->apply :
+// chaque tuile a sa table d'égalisation, construite sur son histogramme écrêté à
+// limiteContraste fois la hauteur moyenne d'une case (0 = sans écrêtage), et chaque
+// pixel interpole les tables des quatre tuiles voisines. Le bruit des zones uniformes
+// n'est plus amplifié comme par l'égalisation globale. Les tuiles puis les bandes de
+// lignes sont réparties sur nombreThreads threads (0 = un par coeur).
+void egaliserHistogrammeClahe(const cv::Mat& image, cv::Mat& resultat, double limiteContraste, int tuilesX,
+                              int tuilesY, int nombreThreads);
+
+void egaliserHistogrammeClahe(const cv::Mat& image, cv::Mat& resultat, double limiteContraste = 40.0,
+                              int tuilesX = 8, int tuilesY = 8);
+
+// Étire l'histogramme de chaque canal entre newMin et newMax ; le résultat a le type
+// de l'image (8U, 16U ou 32F, 1, 3 ou 4 canaux). Les bornes sont trouvées par une
+// réduction min/max, puis les types entiers passent par une table de correspondance.
+void etirerHistogramme(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax);
+
+// Même étirement pour une image 8 bits dont on a déjà l'histogramme (une ligne de 256
+// cases CV_32F par canal, comme monCalcHist ou calculerHistogrammeCanaux) : les bornes
+// sont lues dans l'histogramme et l'image n'est parcourue qu'une fois
+void etirerHistogramme(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax, const cv::Mat& hist);
+
+// Bornes d'étirement lues dans la ligne `canal` d'un histogramme cumulé : l'intensité
+// sous laquelle tombent percentileBas des pixels, et celle sous laquelle en tombent
+// percentileHaut (par exemple 0.01 et 0.99)
+void bornesPercentiles(const cv::Mat& histCumule, int canal, double percentileBas, double percentileHaut,
+                       double& minVal, double& maxVal);
+
+// Étirement avec saturation d'une image 8 bits : les bornes sont prises aux percentiles
+// du cumul (calculerHistogrammeCumule ou imgToHistoCumul, une ligne par canal), et les
+// pixels en dehors sont saturés à newMin ou newMax. Quelques pixels isolés très clairs
+// ou très sombres ne gâchent plus l'étirement. Même table que etirerHistogramme.
+void etirerHistogrammePercentiles(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax,
+                                  const cv::Mat& histCumule, double percentileBas, double percentileHaut);
+
+// Même chose en calculant l'histogramme cumulé
+void etirerHistogrammePercentiles(const cv::Mat& image, cv::Mat& imageEtiree, double newMin, double newMax,
+                                  double percentileBas = 0.01, double percentileHaut = 0.99);
+
+#endif
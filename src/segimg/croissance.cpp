@@ -0,0 +1,202 @@
+#include "croissance.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include "histogramme.hpp"
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+// Une case garde la région au-dessus des 8 bits du niveau de gris
+static const int NB_REGIONS_MAX = INT32_MAX >> 8;
+
+// Somme et nombre des pixels déjà ajoutés à une région, et sa moyenne courante
+struct RegionCroissance {
+    int64_t somme;
+    int64_t nombre;
+    double moyenne;
+
+    RegionCroissance() : somme(0), nombre(0), moyenne(0.0) {}
+};
+
+// Un germe : sa position dans le tableau bordé et sa région
+struct Germe {
+    uint32_t indice;
+    int32_t region;
+};
+
+// Écart-type des niveaux de gris, à partir de l'histogramme de monCalcHist
+static double ecartTypeHistogramme(const cv::Mat& image) {
+    cv::Mat hist;
+    monCalcHist(image, hist);
+    const float* bins = hist.ptr<float>(0);
+    double nombre = 0.0, somme = 0.0, sommeCarres = 0.0;
+    for (int v = 0; v < 256; ++v) {
+        nombre += bins[v];
+        somme += static_cast<double>(bins[v]) * v;
+        sommeCarres += static_cast<double>(bins[v]) * v * v;
+    }
+    if (nombre == 0.0) {
+        return 0.0;
+    }
+    double moyenne = somme / nombre;
+    return std::sqrt(std::max(sommeCarres / nombre - moyenne * moyenne, 0.0));
+}
+
+static bool verifierCroissance(const cv::Mat& image, const OptionsCroissance& options) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "croissanceRegions : l'image doit etre en niveaux de gris 8 bits" << std::endl;
+        return false;
+    }
+    if (options.connexite != 4 && options.connexite != 8) {
+        std::cerr << "croissanceRegions : la connexite doit valoir 4 ou 8" << std::endl;
+        return false;
+    }
+    // Les indices du tableau bordé tiennent dans la file sur 32 bits
+    if (static_cast<uint64_t>(image.rows + 2) * (image.cols + 2) > UINT32_MAX) {
+        std::cerr << "croissanceRegions : image trop grande" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void croitre(const cv::Mat& image, const std::vector<Germe>& germes, int nbRegions, cv::Mat& etiquettes,
+                    const OptionsCroissance& options) {
+    const double tolerance = options.tolerance > 0.0 ? options.tolerance
+                                                     : options.facteur * ecartTypeHistogramme(image);
+
+    // Une case par pixel, bordée d'un pixel : (région << 8) | niveau de gris. Un voisin
+    // se lit en un seul accès ; région 0 = pas encore atteint, et le bord vaut -1, dont
+    // la région n'est jamais nulle. Chaque case n'est écrite qu'une fois, ligne par ligne
+    // en parallèle
+    cv::Mat bordee(image.rows + 2, image.cols + 2, CV_32S);
+    executerEnParallele(bordee.rows, nombreThreadsParDefaut(), [&](int y) {
+        int32_t* sortie = bordee.ptr<int32_t>(y);
+        if (y == 0 || y == bordee.rows - 1) {
+            std::fill(sortie, sortie + bordee.cols, -1);
+            return;
+        }
+        const uchar* ligne = image.ptr<uchar>(y - 1);
+        sortie[0] = -1;
+        for (int x = 0; x < image.cols; ++x) {
+            sortie[x + 1] = ligne[x];
+        }
+        sortie[image.cols + 1] = -1;
+    });
+    int32_t* cases = bordee.ptr<int32_t>(0);
+    const int largeur = bordee.cols;
+
+    const int nbVoisins = options.connexite;
+    const int voisins[8] = {-1, 1, -largeur, largeur, -largeur - 1, -largeur + 1, largeur - 1, largeur + 1};
+
+    // Les germes partent au niveau 0 ; la moyenne initiale d'une région est celle de ses
+    // germes, et un germe déjà pris par une autre région est ignoré
+    std::vector<RegionCroissance> regions(nbRegions + 1);
+    std::vector<int64_t> nombresGermes(nbRegions + 1, 0);
+    FileNiveaux file;
+    for (size_t i = 0; i < germes.size(); ++i) {
+        int32_t& valeur = cases[germes[i].indice];
+        if ((valeur >> 8) != 0) {
+            continue;
+        }
+        regions[germes[i].region].moyenne += valeur;
+        ++nombresGermes[germes[i].region];
+        valeur |= germes[i].region << 8;
+        file.ajouter(0, germes[i].indice);
+    }
+    for (int r = 1; r <= nbRegions; ++r) {
+        if (nombresGermes[r] > 0) {
+            regions[r].moyenne /= nombresGermes[r];
+        }
+    }
+
+    // Un pixel prend la région qui l'a mis dans la file : il n'y entre qu'une fois
+    while (!file.vide()) {
+        const uint32_t p = file.retirer();
+        const int32_t marque = cases[p] & ~0xFF;
+        RegionCroissance& region = regions[marque >> 8];
+        region.somme += cases[p] & 0xFF;
+        ++region.nombre;
+        region.moyenne = static_cast<double>(region.somme) / region.nombre;
+
+        for (int k = 0; k < nbVoisins; ++k) {
+            const uint32_t q = p + voisins[k];
+            const int32_t valeur = cases[q];
+            if ((valeur >> 8) != 0) {
+                continue;
+            }
+            const double ecart = std::abs(valeur - region.moyenne);
+            if (ecart <= tolerance) {
+                cases[q] = marque | valeur;
+                file.ajouter(static_cast<int>(ecart + 0.5), q);
+            }
+        }
+    }
+
+    // On ne garde que les régions, sur place : etiquettes est l'intérieur de la bordure
+    executerEnParallele(image.rows, nombreThreadsParDefaut(), [&](int y) {
+        int32_t* ligne = bordee.ptr<int32_t>(y + 1) + 1;
+        for (int x = 0; x < image.cols; ++x) {
+            ligne[x] >>= 8;
+        }
+    });
+    etiquettes = bordee(cv::Rect(1, 1, image.cols, image.rows));
+}
+
+bool croissanceRegions(const cv::Mat& image, const std::vector<cv::Point>& germes, cv::Mat& etiquettes,
+                       const OptionsCroissance& options) {
+    if (!verifierCroissance(image, options)) {
+        return false;
+    }
+    if (germes.size() > static_cast<size_t>(NB_REGIONS_MAX)) {
+        std::cerr << "croissanceRegions : au plus " << NB_REGIONS_MAX << " germes" << std::endl;
+        return false;
+    }
+    std::vector<Germe> germesBordes(germes.size());
+    for (size_t i = 0; i < germes.size(); ++i) {
+        const cv::Point& germe = germes[i];
+        if (germe.x < 0 || germe.y < 0 || germe.x >= image.cols || germe.y >= image.rows) {
+            std::cerr << "croissanceRegions : le germe (" << germe.x << ", " << germe.y << ") est hors de l'image"
+                      << std::endl;
+            return false;
+        }
+        germesBordes[i].indice = static_cast<uint32_t>(static_cast<size_t>(germe.y + 1) * (image.cols + 2) + germe.x + 1);
+        germesBordes[i].region = static_cast<int32_t>(i + 1);
+    }
+    croitre(image, germesBordes, static_cast<int>(germes.size()), etiquettes, options);
+    return true;
+}
+
+bool croissanceRegions(const cv::Mat& image, const cv::Mat& marqueurs, cv::Mat& etiquettes,
+                       const OptionsCroissance& options) {
+    if (!verifierCroissance(image, options)) {
+        return false;
+    }
+    if (marqueurs.type() != CV_32SC1 || marqueurs.size() != image.size()) {
+        std::cerr << "croissanceRegions : les marqueurs doivent etre une image CV_32S de la taille de l'image"
+                  << std::endl;
+        return false;
+    }
+    std::vector<Germe> germes;
+    int nbRegions = 0;
+    for (int y = 0; y < marqueurs.rows; ++y) {
+        const int* ligne = marqueurs.ptr<int>(y);
+        for (int x = 0; x < marqueurs.cols; ++x) {
+            if (ligne[x] > NB_REGIONS_MAX) {
+                std::cerr << "croissanceRegions : les etiquettes des marqueurs vont au plus a " << NB_REGIONS_MAX
+                          << std::endl;
+                return false;
+            }
+            if (ligne[x] > 0) {
+                Germe germe;
+                germe.indice = static_cast<uint32_t>(static_cast<size_t>(y + 1) * (image.cols + 2) + x + 1);
+                germe.region = ligne[x];
+                germes.push_back(germe);
+                nbRegions = std::max(nbRegions, ligne[x]);
+            }
+        }
+    }
+    croitre(image, germes, nbRegions, etiquettes, options);
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef SEGIMG_CROISSANCE_HPP
+#define SEGIMG_CROISSANCE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Paramètres de la croissance de régions
+struct OptionsCroissance {
+    // 4 ou 8
+    int connexite;
+    // Un pixel rejoint une région si son écart à la moyenne de la région ne dépasse pas
+    // facteur x l'écart-type des niveaux de l'image, lu dans son histogramme
+    double facteur;
+    // Si positive, cette tolérance en niveaux de gris remplace facteur x écart-type
+    double tolerance;
+
+    OptionsCroissance() : connexite(4), facteur(0.5), tolerance(0.0) {}
+};
+
+// Croissance de régions à partir de germes, sur une image 8 bits en niveaux de gris.
+// Toutes les régions grandissent en même temps : à chaque étape, on ajoute à sa région
+// le pixel de la frontière le plus proche (en niveau de gris) de la moyenne de la région
+// qui l'a atteint, tant que l'écart reste dans la tolérance. La frontière est une file à
+// 256 niveaux (FileNiveaux). La région et le niveau de chaque pixel sont rangés dans une
+// même case d'un tableau à plat bordé d'un pixel : un voisin se lit en un accès, sans
+// test de bord. La région du germe germes[i] reçoit l'étiquette i + 1 dans etiquettes
+// (CV_32S, vue sur l'intérieur du tableau bordé, donc non continue) ; les pixels
+// qu'aucune région n'atteint restent à 0. Renvoie false si l'image, la connexité ou un
+// germe ne conviennent pas.
+bool croissanceRegions(const cv::Mat& image, const std::vector<cv::Point>& germes, cv::Mat& etiquettes,
+                       const OptionsCroissance& options = OptionsCroissance());
+
+// Les germes sont les pixels d'étiquette positive de marqueurs (CV_32S), par exemple
+// des composantes de etiqueterComposantes : une région peut partir de plusieurs pixels,
+// et sa moyenne initiale est celle de ses germes. etiquettes peut être marqueurs.
+bool croissanceRegions(const cv::Mat& image, const cv::Mat& marqueurs, cv::Mat& etiquettes,
+                       const OptionsCroissance& options = OptionsCroissance());
+
+#endif
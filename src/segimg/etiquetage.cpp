@@ -0,0 +1,344 @@
+#include "etiquetage.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+// Hauteur minimale d'une bande : en dessous, la fusion des coutures coûte plus que ce
+// que la bande fait gagner
+static const int HAUTEUR_MIN_BANDE_ETIQUETAGE = 32;
+
+// Statistiques d'une étiquette provisoire, fusionnées ensuite dans celles de sa
+// composante
+struct StatistiquesProvisoires {
+    int64_t aire;
+    int64_t sommeX;
+    int64_t sommeY;
+    int xMin, yMin, xMax, yMax;
+
+    StatistiquesProvisoires() : aire(0), sommeX(0), sommeY(0), xMin(INT_MAX), yMin(INT_MAX), xMax(-1), yMax(-1) {}
+
+    void ajouter(int x, int y) {
+        ++aire;
+        sommeX += x;
+        sommeY += y;
+        xMin = std::min(xMin, x);
+        xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y);
+        yMax = std::max(yMax, y);
+    }
+
+    void fusionner(const StatistiquesProvisoires& autre) {
+        aire += autre.aire;
+        sommeX += autre.sommeX;
+        sommeY += autre.sommeY;
+        xMin = std::min(xMin, autre.xMin);
+        xMax = std::max(xMax, autre.xMax);
+        yMin = std::min(yMin, autre.yMin);
+        yMax = std::max(yMax, autre.yMax);
+    }
+};
+
+// Une bande de lignes [debut, fin[ étiquetée de son côté : ses étiquettes provisoires
+// vont de 1 à parents.size() - 1, l'indice 0 (le fond) n'est pas utilisé
+struct BandeEtiquetee {
+    int debut;
+    int fin;
+    std::vector<int> parents;
+    std::vector<StatistiquesProvisoires> statistiques;
+
+    int nouvelleEtiquette() {
+        int etiquette = static_cast<int>(parents.size());
+        parents.push_back(etiquette);
+        return etiquette;
+    }
+
+    // e reçoit aussi l'étiquette autre : si e n'en a pas encore, il la prend telle quelle
+    int fusionner(int e, int autre) {
+        if (e == 0) {
+            return autre;
+        }
+        if (e != autre) {
+            unirEtiquettes(parents.data(), e, autre);
+        }
+        return e;
+    }
+};
+
+// Connexité 8 par blocs de 2x2 : le bloc X (pixels a b / c d) regarde les blocs P (haut
+// gauche), Q (haut), R (haut droite) et S (gauche), seulement à travers les pixels qui
+// les touchent :
+//      p  q0 q1 r
+//      s0 a  b
+//      s1 c  d
+// Une fusion est sautée quand les deux voisins se touchent déjà entre eux : ils ont été
+// fusionnés quand le second a été étiqueté.
+template<bool Statistiques>
+static void etiqueterBande8(const cv::Mat& image, cv::Mat& etiquettes, BandeEtiquetee& bande) {
+    const int largeur = image.cols;
+    const int nbBlocs = (largeur + 1) / 2;
+    // Étiquettes des blocs de la rangée précédente et de la rangée courante, décalées d'un
+    // indice pour que les voisins du premier et du dernier bloc existent
+    std::vector<int> precedente(nbBlocs + 2, 0);
+    std::vector<int> courante(nbBlocs + 2, 0);
+
+    for (int y = bande.debut; y < bande.fin; y += 2) {
+        const bool bas = y + 1 < bande.fin;
+        const bool haut = y > bande.debut;
+        const uchar* ligne = image.ptr<uchar>(y);
+        const uchar* ligneBas = bas ? image.ptr<uchar>(y + 1) : 0;
+        const uchar* ligneHaut = haut ? image.ptr<uchar>(y - 1) : 0;
+        int* etiq = etiquettes.ptr<int>(y);
+        int* etiqBas = bas ? etiquettes.ptr<int>(y + 1) : 0;
+
+        for (int bloc = 0; bloc < nbBlocs; ++bloc) {
+            const int x = 2 * bloc;
+            const bool droite = x + 1 < largeur;
+            const bool a = ligne[x] != 0;
+            const bool b = droite && ligne[x + 1] != 0;
+            const bool c = bas && ligneBas[x] != 0;
+            const bool d = bas && droite && ligneBas[x + 1] != 0;
+
+            int e = 0;
+            if (a || b || c || d) {
+                const bool p = haut && x > 0 && ligneHaut[x - 1] != 0;
+                const bool q0 = haut && ligneHaut[x] != 0;
+                const bool q1 = haut && droite && ligneHaut[x + 1] != 0;
+                const bool r = haut && x + 2 < largeur && ligneHaut[x + 2] != 0;
+                const bool s0 = x > 0 && ligne[x - 1] != 0;
+                const bool s1 = bas && x > 0 && ligneBas[x - 1] != 0;
+
+                const bool lieQ = (a || b) && (q0 || q1);
+                const bool lieP = a && p;
+                if (lieQ) {
+                    e = precedente[bloc + 1];
+                }
+                // P touche Q par p - q0
+                if (lieP && !(lieQ && q0)) {
+                    e = bande.fusionner(e, precedente[bloc]);
+                }
+                // R touche Q par q1 - r
+                if (b && r && !(lieQ && q1)) {
+                    e = bande.fusionner(e, precedente[bloc + 2]);
+                }
+                // S touche Q par s0 - q0, et P par s0 - p
+                if ((a || c) && (s0 || s1) && !(s0 && ((lieQ && q0) || lieP))) {
+                    e = bande.fusionner(e, courante[bloc]);
+                }
+                if (e == 0) {
+                    e = bande.nouvelleEtiquette();
+                    if (Statistiques) {
+                        bande.statistiques.push_back(StatistiquesProvisoires());
+                    }
+                }
+                if (Statistiques) {
+                    StatistiquesProvisoires& stats = bande.statistiques[e];
+                    if (a) stats.ajouter(x, y);
+                    if (b) stats.ajouter(x + 1, y);
+                    if (c) stats.ajouter(x, y + 1);
+                    if (d) stats.ajouter(x + 1, y + 1);
+                }
+            }
+            courante[bloc + 1] = e;
+
+            etiq[x] = a ? e : 0;
+            if (droite) etiq[x + 1] = b ? e : 0;
+            if (bas) {
+                etiqBas[x] = c ? e : 0;
+                if (droite) etiqBas[x + 1] = d ? e : 0;
+            }
+        }
+        precedente.swap(courante);
+    }
+}
+
+// Connexité 4 pixel par pixel : un pixel ne regarde que son voisin du haut et celui de
+// gauche, qui sont déjà liés si le pixel en haut à gauche est allumé
+template<bool Statistiques>
+static void etiqueterBande4(const cv::Mat& image, cv::Mat& etiquettes, BandeEtiquetee& bande) {
+    const int largeur = image.cols;
+    for (int y = bande.debut; y < bande.fin; ++y) {
+        const bool haut = y > bande.debut;
+        const uchar* ligne = image.ptr<uchar>(y);
+        const uchar* ligneHaut = haut ? image.ptr<uchar>(y - 1) : 0;
+        int* etiq = etiquettes.ptr<int>(y);
+        const int* etiqHaut = haut ? etiquettes.ptr<int>(y - 1) : 0;
+
+        for (int x = 0; x < largeur; ++x) {
+            if (ligne[x] == 0) {
+                etiq[x] = 0;
+                continue;
+            }
+            const int eHaut = haut ? etiqHaut[x] : 0;
+            const int eGauche = x > 0 ? etiq[x - 1] : 0;
+            int e;
+            if (eHaut != 0) {
+                e = eHaut;
+                if (eGauche != 0 && ligneHaut[x - 1] == 0) {
+                    e = bande.fusionner(e, eGauche);
+                }
+            } else if (eGauche != 0) {
+                e = eGauche;
+            } else {
+                e = bande.nouvelleEtiquette();
+                if (Statistiques) {
+                    bande.statistiques.push_back(StatistiquesProvisoires());
+                }
+            }
+            etiq[x] = e;
+            if (Statistiques) {
+                bande.statistiques[e].ajouter(x, y);
+            }
+        }
+    }
+}
+
+template<bool Statistiques>
+static int etiqueter(const cv::Mat& image, cv::Mat& etiquettes, std::vector<Composante>* composantes,
+                     int connexite, int nombreThreads) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "etiqueterComposantes : l'image doit etre binaire, en niveaux de gris 8 bits" << std::endl;
+        etiquettes.release();
+        return 0;
+    }
+    if (connexite != 4 && connexite != 8) {
+        std::cerr << "etiqueterComposantes : la connexite doit valoir 4 ou 8" << std::endl;
+        etiquettes.release();
+        return 0;
+    }
+
+    // etiquettes peut être l'image elle-même : on garde une référence sur ses pixels
+    cv::Mat source = image;
+    etiquettes.create(source.size(), CV_32S);
+    if (Statistiques) {
+        composantes->clear();
+    }
+    if (source.empty()) {
+        return 0;
+    }
+
+    // Les bandes commencent sur une ligne paire pour que les blocs de 2x2 ne soient
+    // jamais coupés
+    const int nbRangees = (source.rows + 1) / 2;
+    const int nbBandes = std::max(1, std::min(nombreThreadsEffectif(nombreThreads),
+                                              source.rows / HAUTEUR_MIN_BANDE_ETIQUETAGE));
+    std::vector<BandeEtiquetee> bandes(nbBandes);
+    for (int b = 0; b < nbBandes; ++b) {
+        bandes[b].debut = std::min(source.rows, 2 * (nbRangees * b / nbBandes));
+        bandes[b].fin = std::min(source.rows, 2 * (nbRangees * (b + 1) / nbBandes));
+    }
+
+    // Premier passage : chaque bande avec ses propres étiquettes provisoires
+    executerEnParallele(nbBandes, nombreThreads, [&](int b) {
+        BandeEtiquetee& bande = bandes[b];
+        bande.parents.assign(1, 0);
+        if (Statistiques) {
+            bande.statistiques.assign(1, StatistiquesProvisoires());
+        }
+        if (connexite == 8) {
+            etiqueterBande8<Statistiques>(source, etiquettes, bande);
+        } else {
+            etiqueterBande4<Statistiques>(source, etiquettes, bande);
+        }
+    });
+
+    // Les étiquettes de la bande b deviennent globales en ajoutant decalages[b] : on
+    // réunit les union-find des bandes dans un seul tableau, qui reste croissant
+    std::vector<int> decalages(nbBandes);
+    int total = 0;
+    for (int b = 0; b < nbBandes; ++b) {
+        decalages[b] = total;
+        total += static_cast<int>(bandes[b].parents.size()) - 1;
+    }
+    std::vector<int> parents(total + 1, 0);
+    for (int b = 0; b < nbBandes; ++b) {
+        const std::vector<int>& locaux = bandes[b].parents;
+        for (size_t e = 1; e < locaux.size(); ++e) {
+            parents[decalages[b] + e] = decalages[b] + locaux[e];
+        }
+    }
+
+    // Coutures : la première ligne de chaque bande contre la dernière de la précédente
+    const int largeur = source.cols;
+    const int portee = connexite == 8 ? 1 : 0;
+    for (int b = 1; b < nbBandes; ++b) {
+        const int y = bandes[b].debut;
+        if (y >= bandes[b].fin) {
+            continue;
+        }
+        const int* etiq = etiquettes.ptr<int>(y);
+        const int* etiqHaut = etiquettes.ptr<int>(y - 1);
+        for (int x = 0; x < largeur; ++x) {
+            if (etiq[x] == 0) {
+                continue;
+            }
+            const int e = decalages[b] + etiq[x];
+            for (int vx = std::max(0, x - portee); vx <= std::min(largeur - 1, x + portee); ++vx) {
+                if (etiqHaut[vx] != 0) {
+                    unirEtiquettes(parents.data(), e, decalages[b - 1] + etiqHaut[vx]);
+                }
+            }
+        }
+    }
+
+    // Renumérotation : une racine est sa plus petite étiquette, et le parent d'une autre
+    // étiquette est plus petit qu'elle, donc déjà renuméroté
+    std::vector<int> finales(total + 1, 0);
+    int nombre = 0;
+    for (int e = 1; e <= total; ++e) {
+        finales[e] = parents[e] == e ? ++nombre : finales[parents[e]];
+    }
+
+    // Second passage : les étiquettes définitives
+    executerEnParallele(nbBandes, nombreThreads, [&](int b) {
+        const int* table = finales.data() + decalages[b];
+        for (int y = bandes[b].debut; y < bandes[b].fin; ++y) {
+            int* etiq = etiquettes.ptr<int>(y);
+            for (int x = 0; x < largeur; ++x) {
+                if (etiq[x] != 0) {
+                    etiq[x] = table[etiq[x]];
+                }
+            }
+        }
+    });
+
+    if (Statistiques) {
+        std::vector<StatistiquesProvisoires> cumuls(nombre + 1);
+        for (int b = 0; b < nbBandes; ++b) {
+            const std::vector<StatistiquesProvisoires>& locales = bandes[b].statistiques;
+            for (size_t e = 1; e < locales.size(); ++e) {
+                cumuls[finales[decalages[b] + e]].fusionner(locales[e]);
+            }
+        }
+        composantes->resize(nombre);
+        for (int e = 1; e <= nombre; ++e) {
+            const StatistiquesProvisoires& stats = cumuls[e];
+            Composante& composante = (*composantes)[e - 1];
+            composante.aire = static_cast<int>(stats.aire);
+            composante.boite = cv::Rect(stats.xMin, stats.yMin, stats.xMax - stats.xMin + 1, stats.yMax - stats.yMin + 1);
+            composante.centre = cv::Point2d(static_cast<double>(stats.sommeX) / stats.aire,
+                                            static_cast<double>(stats.sommeY) / stats.aire);
+        }
+    }
+    return nombre;
+}
+
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, std::vector<Composante>& composantes,
+                         int connexite, int nombreThreads) {
+    return etiqueter<true>(image, etiquettes, &composantes, connexite, nombreThreads);
+}
+
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, std::vector<Composante>& composantes,
+                         int connexite) {
+    return etiqueterComposantes(image, etiquettes, composantes, connexite, nombreThreadsParDefaut());
+}
+
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, int connexite, int nombreThreads) {
+    return etiqueter<false>(image, etiquettes, 0, connexite, nombreThreads);
+}
+
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, int connexite) {
+    return etiqueterComposantes(image, etiquettes, connexite, nombreThreadsParDefaut());
+}
@@ -0,0 +1,44 @@
+#ifndef SEGIMG_ETIQUETAGE_HPP
+#define SEGIMG_ETIQUETAGE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Une composante connexe : son nombre de pixels, sa boîte englobante et son centre de
+// gravité
+struct Composante {
+    int aire;
+    cv::Rect boite;
+    cv::Point2d centre;
+};
+
+// Étiquetage des composantes connexes d'une image binaire 8 bits (tout pixel non nul
+// appartient à un objet), par exemple la sortie d'un seuillage. etiquettes reçoit une
+// image CV_32S : 0 pour le fond, de 1 au nombre de composantes renvoyé pour les objets
+// (cv::connectedComponents renvoie un de plus, il compte le fond). connexite vaut 4 ou 8.
+//
+// En connexité 8, l'image est parcourue par blocs de 2x2 pixels : les pixels d'un bloc
+// sont toujours connexes entre eux, et le bloc ne regarde que ses quatre voisins déjà
+// vus (haut gauche, haut, haut droite, gauche), en sautant les fusions déjà acquises par
+// un voisin commun. En connexité 4, le parcours se fait pixel par pixel. Les étiquettes
+// provisoires sont rassemblées dans un union-find à plat, avec compression des chemins ;
+// un second passage écrit les étiquettes définitives, numérotées dans l'ordre du premier
+// bloc (ou pixel) de chaque composante.
+//
+// L'image est découpée en bandes de lignes étiquetées chacune de son côté sur
+// nombreThreads threads (0 = un par coeur), puis les équivalences sont fusionnées le long
+// des coutures : le résultat ne dépend pas du nombre de threads. Les statistiques de
+// chaque composante (composantes[e - 1] pour l'étiquette e) sont accumulées pendant le
+// premier passage, sans relire l'image.
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, std::vector<Composante>& composantes,
+                         int connexite, int nombreThreads);
+
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, std::vector<Composante>& composantes,
+                         int connexite = 8);
+
+// Sans les statistiques
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, int connexite, int nombreThreads);
+
+int etiqueterComposantes(const cv::Mat& image, cv::Mat& etiquettes, int connexite = 8);
+
+#endif
@@ -0,0 +1,429 @@
+#include "filtre.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include "integrale.hpp"
+#include "local.hpp"
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+// Nombre minimal de bits après la virgule pour calculer un filtre en virgule fixe.
+// En dessous (coefficients très grands), on calcule en double.
+static const int BITS_MIN_VIRGULE_FIXE = 12;
+
+// Tolérance relative pour décider qu'un filtre est le produit d'une colonne par une ligne
+static const double TOLERANCE_SEPARABLE = 1e-9;
+
+// Le flou récursif traite les lignes par paquets, transposés pour que la récurrence le
+// long d'une ligne avance sur tout le paquet à la fois
+static const int LIGNES_PAR_PAQUET_RECURSIF = 8;
+
+static double sommeValeursAbsolues(const std::vector<double>& valeurs) {
+    double somme = 0.0;
+    for (size_t k = 0; k < valeurs.size(); ++k) {
+        somme += std::abs(valeurs[k]);
+    }
+    return somme;
+}
+
+// Nombre de bits après la virgule utilisables pour qu'une somme de pixels 8 bits
+// pondérés, de valeur absolue au plus 255 * sommeAbs, tienne dans un int32
+static int bitsVirguleDisponibles(double sommeAbs) {
+    if (sommeAbs <= 0.0) {
+        return 16;
+    }
+    return static_cast<int>(std::floor(std::log2(2147483647.0 / (255.0 * sommeAbs))));
+}
+
+// Convertit des coefficients en entiers sur `bits` bits après la virgule. On arrondit
+// les sommes partielles plutôt que chaque coefficient : la somme des coefficients
+// entiers reste l'arrondi de la somme exacte, et un filtre de moyenne rend donc
+// exactement l'intensité d'une zone uniforme.
+static void quantifierCoefficients(const std::vector<double>& coefficients, int bits, std::vector<int32_t>& resultat) {
+    double echelle = std::ldexp(1.0, bits);
+    resultat.resize(coefficients.size());
+
+    double cumul = 0.0;
+    int64_t precedent = 0;
+    for (size_t k = 0; k < coefficients.size(); ++k) {
+        cumul += coefficients[k];
+        int64_t courant = static_cast<int64_t>(std::llround(cumul * echelle));
+        resultat[k] = static_cast<int32_t>(courant - precedent);
+        precedent = courant;
+    }
+}
+
+bool decomposerFiltreSeparable(const cv::Mat& filtre, std::vector<double>& colonne, std::vector<double>& ligne) {
+    // On prend comme pivot le coefficient de plus grande valeur absolue
+    int lignePivot = 0;
+    int colonnePivot = 0;
+    double maxAbs = 0.0;
+    for (int i = 0; i < filtre.rows; ++i) {
+        for (int j = 0; j < filtre.cols; ++j) {
+            if (std::abs(filtre.at<double>(i, j)) > maxAbs) {
+                maxAbs = std::abs(filtre.at<double>(i, j));
+                lignePivot = i;
+                colonnePivot = j;
+            }
+        }
+    }
+    if (maxAbs == 0.0) {
+        return false;
+    }
+
+    colonne.resize(filtre.rows);
+    ligne.resize(filtre.cols);
+    for (int i = 0; i < filtre.rows; ++i) {
+        colonne[i] = filtre.at<double>(i, colonnePivot);
+    }
+    for (int j = 0; j < filtre.cols; ++j) {
+        ligne[j] = filtre.at<double>(lignePivot, j) / filtre.at<double>(lignePivot, colonnePivot);
+    }
+
+    // On vérifie que le produit redonne bien le filtre
+    for (int i = 0; i < filtre.rows; ++i) {
+        for (int j = 0; j < filtre.cols; ++j) {
+            if (std::abs(colonne[i] * ligne[j] - filtre.at<double>(i, j)) > TOLERANCE_SEPARABLE * maxAbs) {
+                return false;
+            }
+        }
+    }
+
+    // On équilibre les deux facteurs pour qu'ils aient à peu près la même somme en valeur
+    // absolue : sinon l'un des deux perd toute sa précision une fois passé en virgule
+    // fixe. Le facteur est une puissance de 2 pour que des coefficients exacts le restent.
+    double equilibre = std::exp2(std::round(0.5 * std::log2(sommeValeursAbsolues(ligne) / sommeValeursAbsolues(colonne))));
+    for (size_t i = 0; i < colonne.size(); ++i) {
+        colonne[i] *= equilibre;
+    }
+    for (size_t j = 0; j < ligne.size(); ++j) {
+        ligne[j] /= equilibre;
+    }
+    return true;
+}
+
+// Les images 8 bits sont filtrées en virgule fixe sur des int32 dès que les coefficients
+// le permettent. Au-delà (16 bits, flottants, très grands coefficients), on calcule en
+// float si la sortie est flottante, en double sinon pour garder un arrondi exact.
+template<typename T, int Canaux>
+static void convolutionSeparable(const cv::Mat& image, const std::vector<double>& colonne, const std::vector<double>& ligne,
+                                 const OptionsFiltre& options, cv::Mat& resultat) {
+    // Les deux passes se partagent les bits disponibles
+    int bitsTotal = bitsVirguleDisponibles(sommeValeursAbsolues(colonne) * sommeValeursAbsolues(ligne));
+
+    if (resultat.depth() == CV_32F) {
+        // Une sortie flottante garde les coefficients exacts : on calcule en float
+        std::vector<float> colonneFlottante(colonne.begin(), colonne.end());
+        std::vector<float> ligneFlottante(ligne.begin(), ligne.end());
+        convolutionSeparableType<float, T, Canaux>(image, colonneFlottante, ligneFlottante, 0, options, resultat);
+    } else if (TraitsPixel<T>::profondeur == CV_8U && bitsTotal >= BITS_MIN_VIRGULE_FIXE) {
+        int bitsColonne = std::min(bitsTotal / 2, 15);
+        int bitsLigne = std::min(bitsTotal - bitsColonne, 15);
+        std::vector<int32_t> colonneFixe, ligneFixe;
+        quantifierCoefficients(colonne, bitsColonne, colonneFixe);
+        quantifierCoefficients(ligne, bitsLigne, ligneFixe);
+        convolutionSeparableType<int32_t, T, Canaux>(image, colonneFixe, ligneFixe, bitsColonne + bitsLigne, options, resultat);
+    } else {
+        convolutionSeparableType<double, T, Canaux>(image, colonne, ligne, 0, options, resultat);
+    }
+}
+
+template<typename T, int Canaux>
+static void convolutionGenerale(const cv::Mat& image, const cv::Mat& filtre, const OptionsFiltre& options, cv::Mat& resultat) {
+    // Le noyau vient de convertTo, il est donc continu en mémoire
+    const double* debut = filtre.ptr<double>(0);
+    std::vector<double> coefficients(debut, debut + filtre.total());
+    int bits = std::min(bitsVirguleDisponibles(sommeValeursAbsolues(coefficients)), 16);
+
+    if (resultat.depth() == CV_32F) {
+        std::vector<float> coefficientsFlottants(coefficients.begin(), coefficients.end());
+        convolutionGeneraleType<float, T, Canaux>(image, coefficientsFlottants, filtre.rows, filtre.cols, 0, options, resultat);
+    } else if (TraitsPixel<T>::profondeur == CV_8U && bits >= BITS_MIN_VIRGULE_FIXE) {
+        std::vector<int32_t> coefficientsFixes;
+        quantifierCoefficients(coefficients, bits, coefficientsFixes);
+        convolutionGeneraleType<int32_t, T, Canaux>(image, coefficientsFixes, filtre.rows, filtre.cols, bits, options, resultat);
+    } else {
+        convolutionGeneraleType<double, T, Canaux>(image, coefficients, filtre.rows, filtre.cols, 0, options, resultat);
+    }
+}
+
+// Choisit une fois pour toutes l'instanciation du type de pixel et du nombre de canaux
+struct Convolution {
+    const cv::Mat& image;
+    const cv::Mat& noyau;
+    const OptionsFiltre& options;
+    cv::Mat& resultat;
+
+    template<typename T, int Canaux>
+    void appliquer() {
+        // Un filtre séparable se calcule en deux passes 1D : hauteur + largeur
+        // multiplications par pixel au lieu de hauteur * largeur
+        std::vector<double> colonne, ligne;
+        if (decomposerFiltreSeparable(noyau, colonne, ligne)) {
+            convolutionSeparable<T, Canaux>(image, colonne, ligne, options, resultat);
+        } else {
+            convolutionGenerale<T, Canaux>(image, noyau, options, resultat);
+        }
+    }
+};
+
+static bool filtreUniforme(const cv::Mat& noyau) {
+    double coefficient = noyau.at<double>(0, 0);
+    for (int m = 0; m < noyau.rows; ++m) {
+        for (int n = 0; n < noyau.cols; ++n) {
+            if (noyau.at<double>(m, n) != coefficient) {
+                return false;
+            }
+        }
+    }
+    return coefficient != 0.0;
+}
+
+cv::Mat appliquerFiltre(const cv::Mat& image, const cv::Mat& filtre, const OptionsFiltre& options) {
+    // On verifie si le filtre est de taille impaire
+    if (filtre.rows % 2 == 0 || filtre.cols % 2 == 0 || filtre.channels() != 1) {
+        std::cerr << "Le filtre doit être de taille impaire." << std::endl;
+        return cv::Mat();
+    }
+    int profondeur = options.profondeurSortie < 0 ? image.depth() : options.profondeurSortie;
+    if (profondeur != CV_8U && profondeur != CV_16U && profondeur != CV_16S && profondeur != CV_32F) {
+        std::cerr << "La sortie du filtre doit être en CV_8U, CV_16U, CV_16S ou CV_32F." << std::endl;
+        return cv::Mat();
+    }
+
+    // On travaille avec des coefficients en double, quel que soit le type du filtre
+    cv::Mat noyau;
+    filtre.convertTo(noyau, CV_64F);
+
+    // On crée une image résultante, avec autant de canaux que l'image
+    cv::Mat resultat = cv::Mat::zeros(image.size(), CV_MAKETYPE(profondeur, image.channels()));
+    if (image.empty() || (options.bord == BORD_ZERO_CADRE && (image.rows < noyau.rows || image.cols < noyau.cols))) {
+        return resultat;
+    }
+
+    // Un filtre dont tous les coefficients sont égaux (flou moyen) est une somme sur une
+    // boîte : en 8 bits, les sommes glissantes la calculent en temps constant par pixel
+    if (image.type() == CV_8UC1 && profondeur == CV_8U && options.operation == SORTIE_BRUTE && options.saturer
+        && options.bord != BORD_ZERO_CADRE && filtreUniforme(noyau)) {
+        return filtreBoite(image, noyau.cols, noyau.rows, noyau.at<double>(0, 0), options.bord,
+                           options.valeurConstante);
+    }
+
+    Convolution convolution = {image, noyau, options, resultat};
+    if (!repartirSelonType(image.type(), convolution)) {
+        std::cerr << "Le filtre s'applique aux images 8U, 16U ou 32F de 1, 3 ou 4 canaux." << std::endl;
+        return cv::Mat();
+    }
+
+    return resultat;
+}
+
+cv::Mat appliquerFiltre(const cv::Mat& image, const cv::Mat& filtre, ModeBord mode, double valeurConstante) {
+    OptionsFiltre options;
+    options.bord = mode;
+    options.valeurConstante = valeurConstante;
+    return appliquerFiltre(image, filtre, options);
+}
+
+cv::Mat filtreMedian(const cv::Mat& image, int taille, ModeBord mode, int nombreThreads) {
+    if (image.type() != CV_8UC1 || taille <= 0 || taille % 2 == 0) {
+        std::cerr << "Le filtre médian attend une image en niveaux de gris 8 bits et une taille impaire." << std::endl;
+        return cv::Mat();
+    }
+    if (mode == BORD_ZERO_CADRE || mode == BORD_CONSTANT) {
+        std::cerr << "Le filtre médian prend un bord par reflet, répliqué ou cyclique." << std::endl;
+        return cv::Mat();
+    }
+    if (image.empty() || taille == 1) {
+        return image.clone();
+    }
+
+    // Au-delà de 5x5, les réseaux de tri grossissent trop vite : l'histogramme glissant
+    // garde un coût constant par pixel
+    int rayon = taille / 2;
+    if (taille > 5) {
+        cv::Mat resultat;
+        filtreRang(image, resultat, rayon, 0.5, mode, nombreThreads);
+        return resultat;
+    }
+
+    // Bandes de lignes indépendantes, lues dans l'image prolongée
+    cv::Mat etendue = prolongerImage(image, rayon, rayon, mode, 0.0);
+    cv::Mat resultat(image.size(), CV_8UC1);
+    int nbBandes = std::min(image.rows, 4 * nombreThreadsEffectif(nombreThreads));
+    executerEnParallele(nbBandes, nombreThreads, [&](int bande) {
+        int debut = image.rows * bande / nbBandes;
+        int fin = image.rows * (bande + 1) / nbBandes;
+        for (int y = debut; y < fin; ++y) {
+            const uchar* lignes[5];
+            for (int m = 0; m < taille; ++m) {
+                lignes[m] = etendue.ptr<uchar>(y + m);
+            }
+            if (taille == 3) {
+                medianeLigne3x3(lignes, resultat.ptr<uchar>(y), image.cols);
+            } else {
+                medianeLigne5x5(lignes, resultat.ptr<uchar>(y), image.cols);
+            }
+        }
+    });
+    return resultat;
+}
+
+cv::Mat filtreMedian(const cv::Mat& image, int taille, ModeBord mode) {
+    return filtreMedian(image, taille, mode, nombreThreadsParDefaut());
+}
+
+// Coefficients de Young et van Vliet pour sigma, et matrice d'amorce du passage
+// retour. Le lien entre q et sigma est celui de l'article de 1995 ; les coefficients
+// viennent de la forme factorisée (un pôle réel et deux complexes conjugués, article de
+// 2002) : développés et arrondis à six chiffres comme en 1995, ils déplacent les pôles
+// dès sigma = 50, où 1 - (a1 + a2 + a3) devient du même ordre que ces arrondis.
+// Plutôt que la formule fermée de Triggs et Sdika, on obtient M en faisant tourner le
+// filtre sur chacun des trois écarts unitaires à la fin du passage aller, jusqu'à
+// extinction : une seule fois par appel.
+static CoefficientsRecursifs coefficientsYoungVanVliet(double sigma) {
+    const double m0 = 1.16680, m1 = 1.10783, m2 = 1.40586;
+    double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+    double echelle = (m0 + q) * (m1 * m1 + m2 * m2 + 2.0 * m1 * q + q * q);
+    double a1 = q * (2.0 * m0 * m1 + m1 * m1 + m2 * m2 + (2.0 * m0 + 4.0 * m1) * q + 3.0 * q * q) / echelle;
+    double a2 = -q * q * (m0 + 2.0 * m1 + 3.0 * q) / echelle;
+    double a3 = q * q * q / echelle;
+    double B = m0 * (m1 * m1 + m2 * m2) / echelle;
+
+    CoefficientsRecursifs c;
+    c.B = B;
+    c.a1 = a1;
+    c.a2 = a2;
+    c.a3 = a3;
+
+    // La réponse décroît comme exp(-n / sigma) à peu près : 20 sigma suffisent largement
+    int longueur = static_cast<int>(20.0 * sigma) + 32;
+    std::vector<double> aller(longueur + 3), retour(longueur + 3);
+    for (int j = 0; j < 3; ++j) {
+        // aller[k + 3] est la sortie k après la fin ; aller[0..2] les trois dernières
+        std::fill(aller.begin(), aller.end(), 0.0);
+        aller[2 - j] = 1.0;
+        for (int k = 3; k < longueur + 3; ++k) {
+            aller[k] = a1 * aller[k - 1] + a2 * aller[k - 2] + a3 * aller[k - 3];
+        }
+        std::fill(retour.begin(), retour.end(), 0.0);
+        for (int k = longueur - 1; k >= 0; --k) {
+            retour[k] = B * aller[k + 3] + a1 * retour[k + 1] + a2 * retour[k + 2] + a3 * retour[k + 3];
+        }
+        for (int i = 0; i < 3; ++i) {
+            c.M[i][j] = retour[i];
+        }
+    }
+    return c;
+}
+
+cv::Mat flouGaussienRecursif(const cv::Mat& image, double sigma, int nombreThreads) {
+    if (!(sigma >= 0.5)) {
+        std::cerr << "Le flou gaussien récursif attend un écart type d'au moins 0,5 pixel." << std::endl;
+        return cv::Mat();
+    }
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    CoefficientsRecursifs coefficients = coefficientsYoungVanVliet(sigma);
+    // En float, la récurrence perd toute précision au-delà de sigma = 50 environ : les
+    // pôles s'approchent trop de 1
+    cv::Mat travail;
+    image.convertTo(travail, CV_64F);
+    int canaux = image.channels();
+    int nbValeurs = image.cols * canaux;
+    int nbThreads = nombreThreadsEffectif(nombreThreads);
+
+    // Passage vertical : chaque tranche de colonnes avance ligne par ligne
+    std::vector<double*> lignes(image.rows);
+    for (int y = 0; y < image.rows; ++y) {
+        lignes[y] = travail.ptr<double>(y);
+    }
+    int nbTranches = std::max(1, std::min(4 * nbThreads, nbValeurs / 64));
+    executerEnParallele(nbTranches, nombreThreads, [&](int tranche) {
+        int debut = nbValeurs * tranche / nbTranches;
+        int fin = nbValeurs * (tranche + 1) / nbTranches;
+        std::vector<double> tampon(5 * (fin - debut));
+        gaussienRecursifLignes(&lignes[0], image.rows, debut, fin, coefficients, &tampon[0]);
+    });
+
+    // Passage horizontal : un paquet de lignes est transposé pour que chaque position x
+    // devienne une courte ligne (paquet x canaux valeurs), filtrée par le même noyau
+    int nbPaquets = (image.rows + LIGNES_PAR_PAQUET_RECURSIF - 1) / LIGNES_PAR_PAQUET_RECURSIF;
+    executerEnParallele(nbPaquets, nombreThreads, [&](int paquet) {
+        int debut = paquet * LIGNES_PAR_PAQUET_RECURSIF;
+        int hauteur = std::min(LIGNES_PAR_PAQUET_RECURSIF, image.rows - debut);
+        int pas = hauteur * canaux;
+        std::vector<double> transpose(image.cols * pas), tampon(5 * pas);
+        std::vector<double*> positions(image.cols);
+        for (int x = 0; x < image.cols; ++x) {
+            positions[x] = &transpose[x * pas];
+        }
+        for (int r = 0; r < hauteur; ++r) {
+            const double* ligne = travail.ptr<double>(debut + r);
+            for (int x = 0; x < image.cols; ++x) {
+                for (int k = 0; k < canaux; ++k) {
+                    positions[x][r * canaux + k] = ligne[x * canaux + k];
+                }
+            }
+        }
+        gaussienRecursifLignes(&positions[0], image.cols, 0, pas, coefficients, &tampon[0]);
+        for (int r = 0; r < hauteur; ++r) {
+            double* ligne = travail.ptr<double>(debut + r);
+            for (int x = 0; x < image.cols; ++x) {
+                for (int k = 0; k < canaux; ++k) {
+                    ligne[x * canaux + k] = positions[x][r * canaux + k];
+                }
+            }
+        }
+    });
+
+    cv::Mat resultat;
+    travail.convertTo(resultat, image.depth());
+    return resultat;
+}
+
+cv::Mat flouGaussienRecursif(const cv::Mat& image, double sigma) {
+    return flouGaussienRecursif(image, sigma, nombreThreadsParDefaut());
+}
+
+cv::Mat gradientSobel(const cv::Mat& image) {
+    if (image.channels() != 1) {
+        std::cerr << "gradientSobel : l'image doit avoir un seul canal" << std::endl;
+        return cv::Mat();
+    }
+    cv::Mat sobelX = (cv::Mat_<double>(3, 3) << -1, 0, 1, -2, 0, 2, -1, 0, 1);
+    OptionsFiltre options;
+    options.bord = BORD_REPLIQUE;
+    options.profondeurSortie = CV_32F;
+    cv::Mat gx = appliquerFiltre(image, sobelX, options);
+    cv::Mat gy = appliquerFiltre(image, sobelX.t(), options);
+    if (gx.empty() || gy.empty()) {
+        return cv::Mat();
+    }
+
+    cv::Mat norme(image.size(), CV_32F);
+    float maximum = 0.0f;
+    for (int y = 0; y < image.rows; ++y) {
+        const float* ligneX = gx.ptr<float>(y);
+        const float* ligneY = gy.ptr<float>(y);
+        float* ligne = norme.ptr<float>(y);
+        for (int x = 0; x < image.cols; ++x) {
+            ligne[x] = std::sqrt(ligneX[x] * ligneX[x] + ligneY[x] * ligneY[x]);
+            maximum = std::max(maximum, ligne[x]);
+        }
+    }
+
+    cv::Mat relief(image.size(), CV_8UC1);
+    const float echelle = maximum > 0.0f ? 255.0f / maximum : 0.0f;
+    for (int y = 0; y < image.rows; ++y) {
+        const float* ligne = norme.ptr<float>(y);
+        uchar* sortie = relief.ptr<uchar>(y);
+        for (int x = 0; x < image.cols; ++x) {
+            sortie[x] = static_cast<uchar>(ligne[x] * echelle + 0.5f);
+        }
+    }
+    return relief;
+}
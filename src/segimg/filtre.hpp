@@ -0,0 +1,84 @@
+#ifndef SEGIMG_FILTRE_HPP
+#define SEGIMG_FILTRE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Gestion des bords dans appliquerFiltre, pour les pixels où le filtre déborde de l'image
+enum ModeBord {
+    BORD_ZERO_CADRE,  // comportement d'origine : ces pixels restent à zéro
+    BORD_REPLIQUE,    // aaaaaa|abcdefgh|hhhhhhh
+    BORD_REFLET,      // fedcba|abcdefgh|hgfedcb
+    BORD_REFLET_101,  // gfedcb|abcdefgh|gfedcba
+    BORD_CONSTANT,    // iiiiii|abcdefgh|iiiiiii
+    BORD_CYCLIQUE     // cdefgh|abcdefgh|abcdefg
+};
+
+// Opération appliquée à chaque valeur filtrée avant la conversion vers la sortie
+enum OperationSortie {
+    SORTIE_BRUTE,           // la valeur telle quelle
+    SORTIE_VALEUR_ABSOLUE,  // |valeur|, pour des contours dans les deux sens
+    SORTIE_DECALAGE_128     // valeur + 128, pour voir le signe dans une image 8 bits
+};
+
+// Options complètes d'appliquerFiltre
+struct OptionsFiltre {
+    ModeBord bord;
+    double valeurConstante;     // valeur des pixels hors de l'image pour BORD_CONSTANT
+    int profondeurSortie;       // CV_8U, CV_16U, CV_16S ou CV_32F, -1 = celle de l'image
+    OperationSortie operation;
+    bool saturer;               // sinon les sorties entières sont tronquées (ancien comportement)
+
+    OptionsFiltre()
+        : bord(BORD_REFLET_101), valeurConstante(0.0), profondeurSortie(-1), operation(SORTIE_BRUTE), saturer(true) {}
+};
+
+// Cherche si le filtre (CV_64F) est le produit d'une colonne par une ligne (filtre de
+// rang 1, comme un flou moyen ou Sobel). Si oui, on peut l'appliquer en deux passes 1D.
+bool decomposerFiltreSeparable(const cv::Mat& filtre, std::vector<double>& colonne, std::vector<double>& ligne);
+
+// Fonction pour appliquer un filtre à une image. Le filtre peut avoir n'importe quelle
+// taille impaire ; comme avant, on calcule une corrélation (le filtre n'est pas
+// retourné). L'image est en 8U, 16U ou 32F, avec 1, 3 ou 4 canaux filtrés chacun de
+// leur côté. Les options choisissent le mode de bord, la profondeur de sortie, la
+// saturation et l'opération (valeur absolue, décalage de 128) faite au moment de
+// l'écriture, sans image intermédiaire.
+// Un filtre dont tous les coefficients sont égaux, sur une image 8 bits en niveaux de
+// gris avec une sortie 8 bits saturée, passe par filtreBoite (integrale.hpp) : son coût
+// par pixel ne dépend plus de sa taille.
+cv::Mat appliquerFiltre(const cv::Mat& image, const cv::Mat& filtre, const OptionsFiltre& options);
+
+// Version courte : sortie saturée de même type que l'image, avec le mode de bord choisi
+cv::Mat appliquerFiltre(const cv::Mat& image, const cv::Mat& filtre, ModeBord mode = BORD_REFLET_101,
+                        double valeurConstante = 0.0);
+
+// Filtre médian taille x taille (taille impaire) d'une image 8 bits en niveaux de
+// gris : contrairement au flou, il retire le bruit impulsionnel (poivre et sel) sans
+// étaler les contours. En 3x3 et 5x5, chaque ligne passe par un réseau de tri sans
+// branchement ; au-delà, par l'histogramme glissant de filtreRang, dont le coût par
+// pixel ne dépend pas de la taille. Les bandes de lignes sont réparties sur
+// nombreThreads threads (0 = un par coeur). Bords répliqués par défaut, comme
+// cv::medianBlur ; les bords constants ne sont pas pris en charge.
+cv::Mat filtreMedian(const cv::Mat& image, int taille, ModeBord mode, int nombreThreads);
+
+cv::Mat filtreMedian(const cv::Mat& image, int taille, ModeBord mode = BORD_REPLIQUE);
+
+// Flou gaussien d'écart type sigma (en pixels, au moins 0,5) par le filtre récursif de
+// Young et van Vliet : trois coefficients par passage, dans chaque sens et sur chaque
+// axe, quel que soit sigma. Là où un noyau de 6 sigma de côté devient hors de prix
+// (aplanissement du fond, sigma de plusieurs dizaines de pixels), le coût par pixel reste
+// constant. Le résultat approche cv::GaussianBlur avec bords répliqués à moins de 1 %
+// de la dynamique à partir de sigma = 3 ; en dessous, un petit noyau passé à
+// appliquerFiltre est plus fidèle. L'image est de n'importe quelle profondeur et nombre
+// de canaux, calculée en double et rendue dans son type. Les colonnes, puis les paquets
+// de lignes, sont répartis sur nombreThreads threads (0 = un par coeur).
+cv::Mat flouGaussienRecursif(const cv::Mat& image, double sigma, int nombreThreads);
+
+cv::Mat flouGaussienRecursif(const cv::Mat& image, double sigma);
+
+// Norme du gradient de Sobel d'une image à un canal, calculée par appliquerFiltre (bords
+// répliqués, sorties flottantes) : sqrt(gx² + gy²), ramenée sur 0..255 en 8 bits par
+// rapport au plus fort gradient de l'image. C'est le relief de ligneDePartageEaux.
+cv::Mat gradientSobel(const cv::Mat& image);
+
+#endif
@@ -0,0 +1,393 @@
+#include "histogramme.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+void minMaxHist(const cv::Mat& hist, double& minVal, double& maxVal) {
+    minVal = std::numeric_limits<double>::max();
+    maxVal = std::numeric_limits<double>::min();
+
+    for (int i = 0; i < hist.cols; ++i) {
+        float binValue = hist.at<float>(0, i);
+        if (binValue < minVal) {
+            minVal = binValue;
+        }
+        if (binValue > maxVal) {
+            maxVal = binValue;
+        }
+    }
+}
+
+void minMaxIm(const cv::Mat& image, double& minVal, double& maxVal) {
+    // On parcourt l'image avec la réduction vectorisée des noyaux
+    minMaxCanaux<uchar, 1>(image, &minVal, &maxVal);
+}
+
+void calculerHistogrammeCumule(const cv::Mat& hist, cv::Mat& histCumule) {
+    int histSize = hist.cols;
+
+    // On crée une matrice pour l'histogramme cumulé (une nouvelle matrice, pour que
+    // hist et histCumule puissent être le même objet, comme dans imgToHistoCumul)
+    cv::Mat cumul(1, histSize, CV_32F);
+
+    // On cumule en double, exact pour des comptes entiers jusqu'à 2^53, et on n'arrondit
+    // en float qu'au moment d'écrire chaque case
+    const float* bins = hist.ptr<float>(0);
+    float* binsCumul = cumul.ptr<float>(0);
+    double somme = 0.0;
+    for (int i = 0; i < histSize; ++i) {
+        somme += bins[i];
+        binsCumul[i] = static_cast<float>(somme);
+    }
+
+    histCumule = cumul;
+}
+
+void monCalcHistNaif(const cv::Mat& image, cv::Mat& hist) {
+    // Nombre de bins dans l'histogramme
+    int histSize = 256;
+
+    // Calculer l'histogramme
+    hist = cv::Mat::zeros(1, histSize, CV_32F);
+
+    for (int i = 0; i < image.rows; ++i) {
+        for (int j = 0; j < image.cols; ++j) {
+            // Trouver l'intensité du pixel (i, j) et incrémenter le compartiment correspondant
+            int intensity = static_cast<int>(image.at<uchar>(i, j));
+            hist.at<float>(0, intensity) += 1.0;
+        }
+    }
+}
+
+// En dessous de ce nombre de pixels, lancer des threads coûte plus cher que le comptage
+const size_t SEUIL_HISTOGRAMME_PARALLELE = 1 << 20;
+
+// Compteurs d'un histogramme de `taille` cases : sur la pile quand la taille est connue
+// à la compilation (les 256 niveaux d'une image 8 bits), sur le tas sinon
+template<typename T, int TailleFixe>
+struct CompteursHistogramme {
+    explicit CompteursHistogramme(int) {}
+    T* donnees() { return valeurs; }
+    T valeurs[TailleFixe];
+};
+
+template<typename T>
+struct CompteursHistogramme<T, 0> {
+    explicit CompteursHistogramme(int taille) : valeurs(new T[taille]) {}
+    T* donnees() { return valeurs.get(); }
+    std::unique_ptr<T[]> valeurs;
+};
+
+// Calcule un histogramme de `taille` cases en découpant l'image en bandes de lignes.
+// Chaque thread compte sa bande dans son propre histogramme avec compterBande(bande,
+// histoBande) puis l'ajoute à l'histogramme commun avec des additions atomiques :
+// aucune section critique, et le résultat est exactement celui du calcul séquentiel
+// puisque tout se fait en entiers. TailleFixe vaut taille si elle est connue à la
+// compilation, 0 sinon : les 256 cases de l'égalisation n'allouent alors rien sur le tas.
+template<int TailleFixe, typename CompterBande>
+static void compterParBandes(const cv::Mat& image, uint32_t* histo, int taille, int nombreThreads,
+                             CompterBande compterBande) {
+    int nbThreads = std::min(nombreThreadsEffectif(nombreThreads), image.rows);
+
+    if (nbThreads <= 1 || image.total() < SEUIL_HISTOGRAMME_PARALLELE) {
+        compterBande(image, histo);
+        return;
+    }
+
+    CompteursHistogramme<std::atomic<uint32_t>, TailleFixe> compteursCommuns(taille);
+    std::atomic<uint32_t>* histoCommun = compteursCommuns.donnees();
+    for (int k = 0; k < taille; ++k) {
+        histoCommun[k].store(0, std::memory_order_relaxed);
+    }
+
+    auto compterUneBande = [&](int bande) {
+        int debut = image.rows * bande / nbThreads;
+        int fin = image.rows * (bande + 1) / nbThreads;
+
+        CompteursHistogramme<uint32_t, TailleFixe> compteursBande(taille);
+        uint32_t* histoBande = compteursBande.donnees();
+        std::fill(histoBande, histoBande + taille, 0u);
+        compterBande(image.rowRange(debut, fin), histoBande);
+
+        for (int k = 0; k < taille; ++k) {
+            if (histoBande[k] != 0) {
+                histoCommun[k].fetch_add(histoBande[k], std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // Le thread appelant traite la première bande lui-même
+    std::vector<std::thread> threads;
+    for (int bande = 1; bande < nbThreads; ++bande) {
+        threads.emplace_back(compterUneBande, bande);
+    }
+    compterUneBande(0);
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+
+    for (int k = 0; k < taille; ++k) {
+        histo[k] = histoCommun[k].load(std::memory_order_relaxed);
+    }
+}
+
+void calculerHistogrammeBrutParallele(const cv::Mat& image, uint32_t histo[256], int nombreThreads) {
+    if (image.type() != CV_8UC1) {
+        calculerHistogrammeBrut(image, histo);
+        return;
+    }
+    compterParBandes<256>(image, histo, 256, nombreThreads, [](const cv::Mat& bande, uint32_t* histoBande) {
+        calculerHistogrammeBrut(bande, histoBande);
+    });
+}
+
+// Instanciation de l'histogramme par canal pour un type de pixel donné
+struct HistogrammeCanaux {
+    const cv::Mat& image;
+    uint32_t* histos;
+    int nbBins;
+    double borneMin;
+    double borneMax;
+    int nombreThreads;
+
+    template<typename T, int Canaux>
+    void appliquer() {
+        // Pour un type entier découpé en cases de 2^k valeurs depuis 0, la case est un
+        // simple décalage ; sinon on calcule la position dans l'intervalle
+        double largeurCase = (borneMax - borneMin) / nbBins;
+        int decalage = 0;
+        while ((1 << decalage) < largeurCase) {
+            ++decalage;
+        }
+        bool parDecalage = std::numeric_limits<T>::is_integer && borneMin == 0.0
+                           && borneMax == TraitsPixel<T>::borneHistogramme() && (1 << decalage) == largeurCase;
+
+        int nb = nbBins;
+        if (parDecalage && Canaux == 1 && decalage == 0 && nbBins == 256) {
+            compterParBandes<256>(image, histos, 256, nombreThreads, [](const cv::Mat& bande, uint32_t* histoBande) {
+                calculerHistogrammeBrut(bande, histoBande);
+            });
+        } else if (parDecalage) {
+            IndexeurDecalage indexeur(decalage);
+            compterParBandes<0>(image, histos, Canaux * nbBins, nombreThreads, [&](const cv::Mat& bande, uint32_t* histoBande) {
+                calculerHistogrammeCanauxBrut<T, Canaux>(bande, histoBande, nb, indexeur);
+            });
+        } else {
+            IndexeurAffine<false> indexeur(nbBins, borneMin, borneMax);
+            compterParBandes<0>(image, histos, Canaux * nbBins, nombreThreads, [&](const cv::Mat& bande, uint32_t* histoBande) {
+                calculerHistogrammeCanauxBrut<T, Canaux>(bande, histoBande, nb, indexeur);
+            });
+        }
+    }
+};
+
+// Nombre de lignes comptées d'un coup avec des compteurs 32 bits : moins de 2^31
+// pixels, pour qu'aucune case ne déborde avant d'être ajoutée aux compteurs finaux
+static int lignesParPaquet(const cv::Mat& image) {
+    return std::max(static_cast<int>((uint64_t(1) << 31) / std::max(image.cols, 1)) - 1, 1);
+}
+
+template<typename Compteur>
+static bool compterCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<Compteur> >& hists, int nbBins,
+                          double borneMin, double borneMax) {
+    if (nbBins <= 0 || !(borneMax > borneMin)) {
+        std::cerr << "L'histogramme demande au moins une case et un intervalle non vide." << std::endl;
+        return false;
+    }
+
+    int nbCanaux = image.channels();
+    hists.assign(nbCanaux, HistogrammeEntier<Compteur>(nbBins));
+    std::vector<uint32_t> histos(nbCanaux * nbBins);
+    int paquet = lignesParPaquet(image);
+
+    for (int debut = 0; debut < image.rows; debut += paquet) {
+        cv::Mat lignes = image.rowRange(debut, std::min(debut + paquet, image.rows));
+        HistogrammeCanaux calcul = {lignes, &histos[0], nbBins, borneMin, borneMax, nombreThreadsParDefaut()};
+        if (!repartirSelonType(image.type(), calcul)) {
+            std::cerr << "L'histogramme s'applique aux images 8U, 16U ou 32F de 1, 3 ou 4 canaux." << std::endl;
+            hists.clear();
+            return false;
+        }
+        for (int c = 0; c < nbCanaux; ++c) {
+            Compteur* compteurs = hists[c].donnees();
+            for (int k = 0; k < nbBins; ++k) {
+                compteurs[k] += histos[c * nbBins + k];
+            }
+        }
+    }
+    return true;
+}
+
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint32_t> >& hists, int nbBins,
+                               double borneMin, double borneMax) {
+    return compterCanaux(image, hists, nbBins, borneMin, borneMax);
+}
+
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint64_t> >& hists, int nbBins,
+                               double borneMin, double borneMax) {
+    return compterCanaux(image, hists, nbBins, borneMin, borneMax);
+}
+
+struct BornesHistogramme {
+    double borneMax;
+
+    template<typename T, int Canaux>
+    void appliquer() {
+        borneMax = TraitsPixel<T>::borneHistogramme();
+    }
+};
+
+static double borneHistogrammeType(int type) {
+    BornesHistogramme bornes = {256.0};
+    repartirSelonType(type, bornes);
+    return bornes.borneMax;
+}
+
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint32_t> >& hists, int nbBins) {
+    return calculerHistogrammeCanaux(image, hists, nbBins, 0.0, borneHistogrammeType(image.type()));
+}
+
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint64_t> >& hists, int nbBins) {
+    return calculerHistogrammeCanaux(image, hists, nbBins, 0.0, borneHistogrammeType(image.type()));
+}
+
+// Une ligne de la vue flottante par canal
+static void versMatCanaux(const std::vector<HistogrammeEntier<uint32_t> >& hists, int nbBins, cv::Mat& hist) {
+    hist.create(static_cast<int>(hists.size()), nbBins, CV_32F);
+    for (size_t c = 0; c < hists.size(); ++c) {
+        cv::Mat ligne = hist.row(static_cast<int>(c));
+        hists[c].enFlottant().copyTo(ligne);
+    }
+}
+
+void calculerHistogrammeCanaux(const cv::Mat& image, cv::Mat& hist, int nbBins, double borneMin, double borneMax) {
+    std::vector<HistogrammeEntier<uint32_t> > hists;
+    if (!calculerHistogrammeCanaux(image, hists, nbBins, borneMin, borneMax)) {
+        hist = cv::Mat();
+        return;
+    }
+    versMatCanaux(hists, nbBins, hist);
+}
+
+void calculerHistogrammeCanaux(const cv::Mat& image, cv::Mat& hist, int nbBins) {
+    std::vector<HistogrammeEntier<uint32_t> > hists;
+    if (!calculerHistogrammeCanaux(image, hists, nbBins)) {
+        hist = cv::Mat();
+        return;
+    }
+    versMatCanaux(hists, nbBins, hist);
+}
+
+template<int Canaux>
+struct Comptage16 {
+    Histogramme16& hist;
+    int canal;
+
+    void operator()(const cv::Mat& bande, uint32_t* compteurs) const {
+        calculerHistogramme16Brut<Canaux>(bande, canal, hist.decalage, hist.blocs, compteurs,
+                                          static_cast<int>(hist.compteurs.size()));
+    }
+};
+
+void calculerHistogramme16(const cv::Mat& image, Histogramme16& hist, int decalage, int canal) {
+    hist.decalage = decalage;
+    hist.compteurs.clear();
+    hist.total = 0;
+    std::fill(hist.blocs, hist.blocs + 256, static_cast<int16_t>(-1));
+
+    int nbCanaux = image.channels();
+    if (image.depth() != CV_16U || nbCanaux > 4 || canal < 0 || canal >= nbCanaux || decalage < 0 || decalage > 8) {
+        std::cerr << "L'histogramme 16 bits attend une image CV_16U et des cases de 2^0 à 2^8 valeurs." << std::endl;
+        return;
+    }
+
+    // Premier niveau : 256 blocs de 256 cases, soit des blocs de 2^(decalage + 8) valeurs
+    std::vector<uint32_t> parBloc(nbCanaux * 256);
+    IndexeurDecalage indexeurBloc(decalage + 8);
+    compterParBandes<0>(image, &parBloc[0], nbCanaux * 256, nombreThreadsParDefaut(),
+                     [&](const cv::Mat& bande, uint32_t* histoBande) {
+        switch (nbCanaux) {
+            case 1: calculerHistogrammeCanauxBrut<ushort, 1>(bande, histoBande, 256, indexeurBloc); break;
+            case 2: calculerHistogrammeCanauxBrut<ushort, 2>(bande, histoBande, 256, indexeurBloc); break;
+            case 3: calculerHistogrammeCanauxBrut<ushort, 3>(bande, histoBande, 256, indexeurBloc); break;
+            default: calculerHistogrammeCanauxBrut<ushort, 4>(bande, histoBande, 256, indexeurBloc); break;
+        }
+    });
+
+    // On range les blocs occupés dans l'ordre des valeurs
+    int nbBlocs = 0;
+    for (int b = 0; b < 256; ++b) {
+        if (parBloc[canal * 256 + b] != 0) {
+            hist.blocs[b] = static_cast<int16_t>(nbBlocs++);
+            hist.total += parBloc[canal * 256 + b];
+        }
+    }
+    if (nbBlocs == 0) {
+        return;
+    }
+    hist.compteurs.resize(nbBlocs * 256);
+
+    // Second niveau : les cases des blocs occupés
+    int taille = nbBlocs * 256;
+    switch (nbCanaux) {
+        case 1: compterParBandes<0>(image, &hist.compteurs[0], taille, nombreThreadsParDefaut(), Comptage16<1>{hist, canal}); break;
+        case 2: compterParBandes<0>(image, &hist.compteurs[0], taille, nombreThreadsParDefaut(), Comptage16<2>{hist, canal}); break;
+        case 3: compterParBandes<0>(image, &hist.compteurs[0], taille, nombreThreadsParDefaut(), Comptage16<3>{hist, canal}); break;
+        default: compterParBandes<0>(image, &hist.compteurs[0], taille, nombreThreadsParDefaut(), Comptage16<4>{hist, canal}); break;
+    }
+}
+
+void histogrammeVersMat(const uint32_t histo[256], cv::Mat& hist) {
+    hist = cv::Mat::zeros(1, 256, CV_32F);
+    float* bins = hist.ptr<float>(0);
+    for (int k = 0; k < 256; ++k) {
+        bins[k] = static_cast<float>(histo[k]);
+    }
+}
+
+void monCalcHistParallele(const cv::Mat& image, cv::Mat& hist, int nombreThreads) {
+    uint32_t histo[256];
+    calculerHistogrammeBrutParallele(image, histo, nombreThreads);
+    histogrammeVersMat(histo, hist);
+}
+
+void calculerHistogramme(const cv::Mat& image, HistogrammeEntier<uint32_t>& hist) {
+    hist.initialiser(256);
+    calculerHistogrammeBrutParallele(image, hist.donnees(), nombreThreadsParDefaut());
+}
+
+void calculerHistogramme(const cv::Mat& image, HistogrammeEntier<uint64_t>& hist) {
+    hist.initialiser(256);
+    uint64_t* compteurs = hist.donnees();
+    int paquet = lignesParPaquet(image);
+    uint32_t histo[256];
+    for (int debut = 0; debut < image.rows; debut += paquet) {
+        calculerHistogrammeBrutParallele(image.rowRange(debut, std::min(debut + paquet, image.rows)), histo,
+                                         nombreThreadsParDefaut());
+        for (int k = 0; k < 256; ++k) {
+            compteurs[k] += histo[k];
+        }
+    }
+}
+
+void monCalcHist(const cv::Mat& image, cv::Mat& hist) {
+    // On compte les pixels avec des compteurs entiers, sur plusieurs coeurs si l'image
+    // est assez grande ; la version flottante n'est qu'une vue de l'histogramme entier
+    HistogrammeEntier<uint32_t> histEntier;
+    calculerHistogramme(image, histEntier);
+    hist = histEntier.enFlottant();
+}
+
+void imgToHistoCumul(const cv::Mat& image, cv::Mat& hist) {
+    // Le cumul est fait sur les compteurs entiers, sans arrondi intermédiaire
+    HistogrammeEntier<uint64_t> histEntier;
+    calculerHistogramme(image, histEntier);
+    histEntier.cumuler(histEntier);
+    hist = histEntier.enFlottant();
+}
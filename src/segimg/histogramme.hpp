@@ -0,0 +1,176 @@
+#ifndef SEGIMG_HISTOGRAMME_HPP
+#define SEGIMG_HISTOGRAMME_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// Histogramme en compteurs entiers : c'est la structure de référence des calculs.
+// Compteur vaut uint32_t (jusqu'à 2^32 - 1 pixels par case) ou uint64_t pour les très
+// grandes mosaïques. Contrairement à des compteurs float, qui cessent d'augmenter
+// exactement au-delà de 2^24, les comptes et le cumul restent exacts. La version
+// CV_32F, pour l'affichage et les fonctions qui prennent un cv::Mat, n'est qu'une vue
+// calculée à la demande.
+template<typename Compteur>
+class HistogrammeEntier {
+public:
+    explicit HistogrammeEntier(int nbCases = 256) : compteurs(nbCases, 0), vueAJour(false) {}
+
+    int nbCases() const { return static_cast<int>(compteurs.size()); }
+
+    // Remet nbCases compteurs à zéro
+    void initialiser(int nbCases) {
+        compteurs.assign(nbCases, 0);
+        vueAJour = false;
+    }
+
+    Compteur operator[](int k) const { return compteurs[k]; }
+
+    Compteur& operator[](int k) {
+        vueAJour = false;
+        return compteurs[k];
+    }
+
+    const Compteur* donnees() const { return &compteurs[0]; }
+
+    Compteur* donnees() {
+        vueAJour = false;
+        return &compteurs[0];
+    }
+
+    uint64_t total() const {
+        uint64_t somme = 0;
+        for (size_t k = 0; k < compteurs.size(); ++k) {
+            somme += compteurs[k];
+        }
+        return somme;
+    }
+
+    // Histogramme cumulé exact, avec le même type de compteur
+    void cumuler(HistogrammeEntier& cumul) const {
+        std::vector<Compteur> resultat(compteurs.size());
+        Compteur somme = 0;
+        for (size_t k = 0; k < compteurs.size(); ++k) {
+            somme += compteurs[k];
+            resultat[k] = somme;
+        }
+        cumul.compteurs.swap(resultat);
+        cumul.vueAJour = false;
+    }
+
+    // Vue CV_32F 1 x nbCases, calculée au premier appel puis gardée jusqu'à la prochaine
+    // modification. Chaque valeur est arrondie une seule fois vers le float le plus
+    // proche ; la vue est une nouvelle matrice à chaque calcul, donc une copie de l'en-tête
+    // gardée par l'appelant ne change pas quand l'histogramme change.
+    const cv::Mat& enFlottant() const {
+        if (!vueAJour) {
+            vue = cv::Mat(1, nbCases(), CV_32F);
+            float* bins = vue.ptr<float>(0);
+            for (size_t k = 0; k < compteurs.size(); ++k) {
+                bins[k] = static_cast<float>(compteurs[k]);
+            }
+            vueAJour = true;
+        }
+        return vue;
+    }
+
+private:
+    std::vector<Compteur> compteurs;
+    mutable cv::Mat vue;
+    mutable bool vueAJour;
+};
+
+// Valeurs minimale et maximale d'un histogramme 1xN en CV_32F
+void minMaxHist(const cv::Mat& hist, double& minVal, double& maxVal);
+
+// Valeurs minimale et maximale d'une image 8 bits
+void minMaxIm(const cv::Mat& image, double& minVal, double& maxVal);
+
+// Histogramme cumulé d'un histogramme CV_32F ; hist et histCumule peuvent être la même
+// matrice. Le cumul se fait en double et chaque case n'est arrondie qu'une fois en
+// float : pas de dérive sur les grandes images.
+void calculerHistogrammeCumule(const cv::Mat& hist, cv::Mat& histCumule);
+
+// Version d'origine de monCalcHist, gardée comme référence pour le benchmark
+void monCalcHistNaif(const cv::Mat& image, cv::Mat& hist);
+
+// Histogramme d'une image 8 bits en 256 compteurs entiers, réparti sur plusieurs
+// threads (0 = un par coeur) ; le résultat est identique au calcul séquentiel
+void calculerHistogrammeBrutParallele(const cv::Mat& image, uint32_t histo[256], int nombreThreads);
+
+// Recopie 256 compteurs entiers dans un histogramme OpenCV 1x256 en CV_32F
+void histogrammeVersMat(const uint32_t histo[256], cv::Mat& hist);
+
+void monCalcHistParallele(const cv::Mat& image, cv::Mat& hist, int nombreThreads);
+
+// Histogramme entier en 256 cases d'une image 8 bits en niveaux de gris. Avec des
+// compteurs uint64_t, l'image est comptée par paquets de moins de 2^31 pixels.
+void calculerHistogramme(const cv::Mat& image, HistogrammeEntier<uint32_t>& hist);
+
+void calculerHistogramme(const cv::Mat& image, HistogrammeEntier<uint64_t>& hist);
+
+// Histogramme 1x256 en CV_32F d'une image 8 bits (vue flottante de calculerHistogramme)
+void monCalcHist(const cv::Mat& image, cv::Mat& hist);
+
+// Histogramme entier de chaque canal d'une image 8U, 16U ou 32F à 1, 3 ou 4 canaux :
+// nbBins cases de même largeur sur [borneMin, borneMax[. Comme dans cv::calcHist, les
+// valeurs hors de l'intervalle ne sont pas comptées. Renvoie false si l'image ou les
+// cases ne conviennent pas.
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint32_t> >& hists, int nbBins,
+                               double borneMin, double borneMax);
+
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint64_t> >& hists, int nbBins,
+                               double borneMin, double borneMax);
+
+// Par défaut, les cases couvrent la dynamique du type : [0, 256[, [0, 65536[ ou [0, 1[
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint32_t> >& hists, int nbBins = 256);
+
+bool calculerHistogrammeCanaux(const cv::Mat& image, std::vector<HistogrammeEntier<uint64_t> >& hists, int nbBins = 256);
+
+// Vue CV_32F des histogrammes par canal : une ligne de nbBins cases par canal
+void calculerHistogrammeCanaux(const cv::Mat& image, cv::Mat& hist, int nbBins, double borneMin, double borneMax);
+
+void calculerHistogrammeCanaux(const cv::Mat& image, cv::Mat& hist, int nbBins = 256);
+
+// Histogramme d'une image 16 bits rangé en deux niveaux. Une case regroupe 2^decalage
+// valeurs (decalage = 0 : 65536 cases) ; les cases sont groupées par blocs de 256, et
+// seuls les blocs qui contiennent au moins un pixel ont des compteurs, rangés à la
+// suite dans l'ordre des valeurs. Une image 12 bits n'occupe ainsi que 16 blocs, soit
+// 16 Ko de compteurs qui restent dans le cache, au lieu de 256 Ko.
+struct Histogramme16 {
+    int decalage;
+    int16_t blocs[256];               // rang de chaque bloc dans compteurs, -1 s'il est vide
+    std::vector<uint32_t> compteurs;  // 256 compteurs par bloc occupé
+    uint64_t total;                   // nombre de pixels comptés
+
+    int nbCases() const { return 65536 >> decalage; }
+
+    // Compteur d'une case, 0 si son bloc est vide
+    uint32_t nombre(int indiceCase) const {
+        int rang = blocs[indiceCase >> 8];
+        return rang < 0 ? 0 : compteurs[(rang << 8) | (indiceCase & 0xFF)];
+    }
+};
+
+// Histogramme du canal `canal` d'une image CV_16U de 1 à 4 canaux, avec des cases de
+// 2^decalage valeurs (0 à 8). Un premier passage repère les blocs occupés, le second
+// compte les cases ; les deux sont répartis sur plusieurs threads.
+void calculerHistogramme16(const cv::Mat& image, Histogramme16& hist, int decalage = 0, int canal = 0);
+
+// Histogramme cumulé, rangé comme hist.compteurs. Cumul est uint32_t tant que l'image a
+// moins de 2^32 pixels, uint64_t au-delà : le cumul reste exact, contrairement à un
+// cumul en float qui perd des unités au-delà de 2^24 pixels.
+template<typename Cumul>
+void calculerHistogrammeCumule16(const Histogramme16& hist, std::vector<Cumul>& cumul) {
+    cumul.resize(hist.compteurs.size());
+    Cumul somme = 0;
+    for (size_t k = 0; k < hist.compteurs.size(); ++k) {
+        somme += hist.compteurs[k];
+        cumul[k] = somme;
+    }
+}
+
+// Histogramme cumulé d'une image
+void imgToHistoCumul(const cv::Mat& image, cv::Mat& hist);
+
+#endif
@@ -0,0 +1,173 @@
+#include "integrale.hpp"
+#include <cmath>
+#include <limits>
+#include "noyaux.hpp"
+
+static bool verifierBoite(const cv::Mat& image, int largeur, int hauteur, ModeBord mode) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "Les filtres boîte attendent une image en niveaux de gris 8 bits." << std::endl;
+        return false;
+    }
+    if (largeur <= 0 || hauteur <= 0 || largeur % 2 == 0 || hauteur % 2 == 0) {
+        std::cerr << "La fenêtre d'un filtre boîte doit avoir des côtés impairs." << std::endl;
+        return false;
+    }
+    if (mode == BORD_ZERO_CADRE) {
+        std::cerr << "Les filtres boîte ne prennent pas le bord BORD_ZERO_CADRE." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Parcourt les fenêtres ligne par ligne : ecrire(y, sommes, sommesCarres) reçoit les
+// sommes des fenêtres de la ligne y (sommesCarres est nul si carres est faux). Pour un
+// parcours dans l'ordre, on n'a pas besoin de toute l'intégrale : la somme de chaque
+// colonne sur hauteur lignes glisse d'une ligne à la suivante, et une somme cumulée le
+// long de la ligne donne les fenêtres. La mémoire reste de l'ordre d'une ligne.
+template<typename Somme, typename Ecrire>
+static void parcourirBoites(const cv::Mat& image, int largeur, int hauteur, ModeBord mode, double valeurConstante,
+                            bool carres, const Ecrire& ecrire) {
+    int rayonX = largeur / 2;
+    int rayonY = hauteur / 2;
+    int nbColonnes = image.cols + 2 * rayonX;
+    uchar constante = cv::saturate_cast<uchar>(valeurConstante);
+
+    std::vector<uchar> entrante(nbColonnes), sortante(nbColonnes, 0);
+    std::vector<Somme> colonnes(nbColonnes, 0), colonnesCarres(carres ? nbColonnes : 0, 0);
+    std::vector<Somme> cumul(nbColonnes + 1), sommes(image.cols), sommesCarres(carres ? image.cols : 0);
+    Somme* carresColonnes = carres ? &colonnesCarres[0] : static_cast<Somme*>(0);
+
+    // Les hauteur - 1 premières lignes de la fenêtre de la ligne 0 (rien ne sort)
+    for (int y = -rayonY; y < rayonY; ++y) {
+        prolongerLigne(image, y, rayonX, mode, constante, &entrante[0]);
+        glisserColonnes(&entrante[0], &sortante[0], nbColonnes, &colonnes[0], carresColonnes);
+    }
+
+    for (int y = 0; y < image.rows; ++y) {
+        prolongerLigne(image, y + rayonY, rayonX, mode, constante, &entrante[0]);
+        if (y > 0) {
+            prolongerLigne(image, y - rayonY - 1, rayonX, mode, constante, &sortante[0]);
+        }
+        glisserColonnes(&entrante[0], &sortante[0], nbColonnes, &colonnes[0], carresColonnes);
+
+        sommerFenetresLigne(&colonnes[0], image.cols, largeur, &cumul[0], &sommes[0]);
+        if (carres) {
+            sommerFenetresLigne(&colonnesCarres[0], image.cols, largeur, &cumul[0], &sommesCarres[0]);
+        }
+        ecrire(y, &sommes[0], carres ? &sommesCarres[0] : static_cast<const Somme*>(0));
+    }
+}
+
+// Les sommes d'une fenêtre largeur x hauteur (et de ses carrés) tiennent-elles en
+// 32 bits ?
+static bool sommes32Bits(int largeur, int hauteur, bool carres) {
+    uint64_t maximum = static_cast<uint64_t>(largeur) * hauteur * (carres ? 255 * 255 : 255);
+    return maximum <= std::numeric_limits<uint32_t>::max();
+}
+
+struct EcritureSomme {
+    cv::Mat& sortie;
+
+    template<typename Somme>
+    void operator()(int y, const Somme* sommes, const Somme*) const {
+        int32_t* destination = sortie.ptr<int32_t>(y);
+        for (int x = 0; x < sortie.cols; ++x) {
+            destination[x] = static_cast<int32_t>(sommes[x]);
+        }
+    }
+};
+
+cv::Mat sommeBoite(const cv::Mat& image, int largeur, int hauteur, ModeBord mode, double valeurConstante) {
+    if (!verifierBoite(image, largeur, hauteur, mode)) {
+        return cv::Mat();
+    }
+    if (static_cast<uint64_t>(largeur) * hauteur * 255 > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+        std::cerr << "La somme de la fenêtre ne tient pas en CV_32S." << std::endl;
+        return cv::Mat();
+    }
+
+    cv::Mat sortie(image.size(), CV_32SC1);
+    if (image.empty()) {
+        return sortie;
+    }
+    EcritureSomme ecriture = {sortie};
+    parcourirBoites<uint32_t>(image, largeur, hauteur, mode, valeurConstante, false, ecriture);
+    return sortie;
+}
+
+struct EcritureFiltreBoite {
+    cv::Mat& sortie;
+    double coefficient;
+
+    template<typename Somme>
+    void operator()(int y, const Somme* sommes, const Somme*) const {
+        // Arrondi et saturation sans appel de fonction : la boucle reste vectorisée
+        uchar* destination = sortie.ptr<uchar>(y);
+        for (int x = 0; x < sortie.cols; ++x) {
+            double valeur = coefficient * static_cast<double>(sommes[x]) + 0.5;
+            valeur = std::min(std::max(valeur, 0.0), 255.0);
+            destination[x] = static_cast<uchar>(static_cast<int>(valeur));
+        }
+    }
+};
+
+cv::Mat filtreBoite(const cv::Mat& image, int largeur, int hauteur, double coefficient, ModeBord mode,
+                    double valeurConstante) {
+    if (!verifierBoite(image, largeur, hauteur, mode)) {
+        return cv::Mat();
+    }
+
+    cv::Mat sortie(image.size(), CV_8UC1);
+    if (image.empty()) {
+        return sortie;
+    }
+    EcritureFiltreBoite ecriture = {sortie, coefficient};
+    if (sommes32Bits(largeur, hauteur, false)) {
+        parcourirBoites<uint32_t>(image, largeur, hauteur, mode, valeurConstante, false, ecriture);
+    } else {
+        parcourirBoites<uint64_t>(image, largeur, hauteur, mode, valeurConstante, false, ecriture);
+    }
+    return sortie;
+}
+
+cv::Mat moyenneBoite(const cv::Mat& image, int largeur, int hauteur, ModeBord mode, double valeurConstante) {
+    return filtreBoite(image, largeur, hauteur, 1.0 / (static_cast<double>(largeur) * hauteur), mode,
+                       valeurConstante);
+}
+
+struct EcritureVariance {
+    cv::Mat& moyenne;
+    cv::Mat& variance;
+    double inverseNombre;
+
+    template<typename Somme>
+    void operator()(int y, const Somme* sommes, const Somme* sommesCarres) const {
+        float* destinationMoyenne = moyenne.ptr<float>(y);
+        float* destinationVariance = variance.ptr<float>(y);
+        for (int x = 0; x < moyenne.cols; ++x) {
+            double m = static_cast<double>(sommes[x]) * inverseNombre;
+            double v = static_cast<double>(sommesCarres[x]) * inverseNombre - m * m;
+            destinationMoyenne[x] = static_cast<float>(m);
+            destinationVariance[x] = static_cast<float>(std::max(v, 0.0));
+        }
+    }
+};
+
+void varianceBoite(const cv::Mat& image, cv::Mat& moyenne, cv::Mat& variance, int largeur, int hauteur,
+                   ModeBord mode, double valeurConstante) {
+    if (!verifierBoite(image, largeur, hauteur, mode)) {
+        return;
+    }
+
+    cv::Mat sortieMoyenne(image.size(), CV_32FC1), sortieVariance(image.size(), CV_32FC1);
+    if (!image.empty()) {
+        EcritureVariance ecriture = {sortieMoyenne, sortieVariance, 1.0 / (static_cast<double>(largeur) * hauteur)};
+        if (sommes32Bits(largeur, hauteur, true)) {
+            parcourirBoites<uint32_t>(image, largeur, hauteur, mode, valeurConstante, true, ecriture);
+        } else {
+            parcourirBoites<uint64_t>(image, largeur, hauteur, mode, valeurConstante, true, ecriture);
+        }
+    }
+    moyenne = sortieMoyenne;
+    variance = sortieVariance;
+}
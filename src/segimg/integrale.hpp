@@ -0,0 +1,166 @@
+#ifndef SEGIMG_INTEGRALE_HPP
+#define SEGIMG_INTEGRALE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "filtre.hpp"
+
+// Image intégrale d'une image 8 bits en niveaux de gris : la case (y, x) contient la
+// somme des pixels au-dessus et à gauche de (y, x), exclus, et de même pour leurs
+// carrés. La somme de n'importe quel rectangle se lit alors en 4 accès, quelle que soit
+// sa taille. Somme vaut uint32_t ou uint64_t : les calculs se font modulo 2^32 ou 2^64,
+// et la somme d'un rectangle reste exacte tant qu'elle tient dans Somme, même si
+// l'intégrale elle-même déborde. En uint32_t, c'est le cas pour les sommes de
+// rectangles de moins de 2^32 / 255 pixels, et pour les sommes de carrés de rectangles
+// de moins de 2^32 / 255^2 = 66051 pixels (257 x 257).
+//
+// Elle sert quand on lit des rectangles dans un ordre quelconque, ou plusieurs fois la
+// même zone, ou quand l'image arrive par bandes (ajouterLignes) ou change à partir
+// d'une ligne (mettreAJour). Les filtres boîte ci-dessous, qui lisent les fenêtres dans
+// l'ordre des lignes, s'en passent.
+template<typename Somme>
+class ImageIntegrale {
+public:
+    ImageIntegrale() : nbColonnes(0), nbLignes(0), avecCarres(false) {}
+
+    int largeur() const { return nbColonnes; }
+    int hauteur() const { return nbLignes; }
+
+    // Calcule l'intégrale de l'image (et celle des carrés si carres est vrai)
+    void calculer(const cv::Mat& image, bool carres = true) {
+        nbColonnes = 0;
+        nbLignes = 0;
+        avecCarres = carres;
+        sommes.clear();
+        sommesCarres.clear();
+        ajouterLignes(image);
+    }
+
+    // Ajoute des lignes en bas de l'image déjà intégrée (même largeur) : une image qui
+    // arrive bande par bande, d'un scanner ou d'un capteur, est intégrée au fur et à
+    // mesure sans recalculer les lignes précédentes
+    void ajouterLignes(const cv::Mat& lignes) {
+        if (lignes.type() != CV_8UC1 || (nbLignes > 0 && lignes.cols != nbColonnes)) {
+            std::cerr << "L'image intégrale attend des lignes 8 bits en niveaux de gris de même largeur." << std::endl;
+            return;
+        }
+        if (nbLignes == 0) {
+            nbColonnes = lignes.cols;
+            sommes.assign(nbColonnes + 1, 0);
+            sommesCarres.assign(avecCarres ? nbColonnes + 1 : 0, 0);
+        }
+        int premiere = nbLignes;
+        nbLignes += lignes.rows;
+        sommes.resize(static_cast<size_t>(nbLignes + 1) * (nbColonnes + 1));
+        sommesCarres.resize(avecCarres ? sommes.size() : 0);
+        for (int y = 0; y < lignes.rows; ++y) {
+            integrerLigne(lignes.ptr<uchar>(y), premiere + y);
+        }
+    }
+
+    // Recalcule l'intégrale à partir de la ligne premiereLigne, après une modification
+    // de l'image qui ne touche que cette ligne et les suivantes
+    void mettreAJour(const cv::Mat& image, int premiereLigne) {
+        if (image.type() != CV_8UC1 || image.cols != nbColonnes || image.rows != nbLignes) {
+            std::cerr << "La mise à jour attend l'image déjà intégrée." << std::endl;
+            return;
+        }
+        for (int y = std::max(premiereLigne, 0); y < nbLignes; ++y) {
+            integrerLigne(image.ptr<uchar>(y), y);
+        }
+    }
+
+    // Ligne y de l'intégrale (nbColonnes + 1 cases, y de 0 à nbLignes)
+    const Somme* ligne(int y) const { return &sommes[static_cast<size_t>(y) * (nbColonnes + 1)]; }
+    const Somme* ligneCarres(int y) const { return &sommesCarres[static_cast<size_t>(y) * (nbColonnes + 1)]; }
+
+    // Somme des pixels du rectangle [x0, x1[ x [y0, y1[
+    Somme somme(int x0, int y0, int x1, int y1) const {
+        return lireRectangle(ligne(y0), ligne(y1), x0, x1);
+    }
+
+    Somme sommeCarres(int x0, int y0, int x1, int y1) const {
+        return lireRectangle(ligneCarres(y0), ligneCarres(y1), x0, x1);
+    }
+
+    // Sommes des nb rectangles largeur x hauteur dont le coin haut gauche est en
+    // (x, y), x de 0 à nb - 1 : une boucle sans dépendance, vectorisée
+    void sommesLigne(int y, int largeurRectangle, int hauteurRectangle, int nb, Somme* resultat) const {
+        sommesRectangles(ligne(y), ligne(y + hauteurRectangle), largeurRectangle, nb, resultat);
+    }
+
+    void sommesCarresLigne(int y, int largeurRectangle, int hauteurRectangle, int nb, Somme* resultat) const {
+        sommesRectangles(ligneCarres(y), ligneCarres(y + hauteurRectangle), largeurRectangle, nb, resultat);
+    }
+
+private:
+    static Somme lireRectangle(const Somme* haut, const Somme* bas, int x0, int x1) {
+        return static_cast<Somme>(bas[x1] - bas[x0] - haut[x1] + haut[x0]);
+    }
+
+    static void sommesRectangles(const Somme* haut, const Somme* bas, int largeurRectangle, int nb, Somme* resultat) {
+        for (int x = 0; x < nb; ++x) {
+            resultat[x] = static_cast<Somme>(bas[x + largeurRectangle] - bas[x] - haut[x + largeurRectangle] + haut[x]);
+        }
+    }
+
+    // Ligne y + 1 de l'intégrale = ligne y + cumul de la ligne y de l'image
+    void integrerLigne(const uchar* source, int y) {
+        size_t pas = nbColonnes + 1;
+        const Somme* dessus = &sommes[y * pas];
+        Somme* courante = &sommes[(y + 1) * pas];
+        Somme cumul = 0;
+        courante[0] = 0;
+        for (int x = 0; x < nbColonnes; ++x) {
+            cumul = static_cast<Somme>(cumul + source[x]);
+            courante[x + 1] = static_cast<Somme>(dessus[x + 1] + cumul);
+        }
+        if (!avecCarres) {
+            return;
+        }
+        const Somme* dessusCarres = &sommesCarres[y * pas];
+        Somme* courantesCarres = &sommesCarres[(y + 1) * pas];
+        Somme cumulCarres = 0;
+        courantesCarres[0] = 0;
+        for (int x = 0; x < nbColonnes; ++x) {
+            cumulCarres = static_cast<Somme>(cumulCarres + static_cast<uint32_t>(source[x]) * source[x]);
+            courantesCarres[x + 1] = static_cast<Somme>(dessusCarres[x + 1] + cumulCarres);
+        }
+    }
+
+    int nbColonnes;
+    int nbLignes;
+    bool avecCarres;
+    std::vector<Somme> sommes;
+    std::vector<Somme> sommesCarres;
+};
+
+// Filtres boîte d'une image 8 bits en niveaux de gris sur une fenêtre largeur x hauteur
+// (impaires) centrée sur chaque pixel, en temps constant par pixel quelle que soit la
+// taille : l'image est prolongée ligne par ligne selon le mode de bord (BORD_ZERO_CADRE
+// n'est pas pris en charge). Sans construire d'intégrale, on fait glisser la somme de
+// chaque colonne sur hauteur lignes d'une ligne à la suivante, puis une somme cumulée le
+// long de la ligne donne chaque fenêtre par une différence ; la mémoire reste de l'ordre
+// d'une ligne. Les sommes glissantes sont en uint32_t quand les sommes de la fenêtre (et
+// de ses carrés pour varianceBoite) y tiennent, en uint64_t sinon.
+
+// Somme de la fenêtre, en CV_32S (fenêtres de moins de 2^31 / 255 pixels)
+cv::Mat sommeBoite(const cv::Mat& image, int largeur, int hauteur, ModeBord mode = BORD_REFLET_101,
+                   double valeurConstante = 0.0);
+
+// coefficient x somme de la fenêtre, arrondi et saturé en 8 bits : la moyenne pour
+// coefficient = 1 / (largeur x hauteur), comme cv::blur
+cv::Mat filtreBoite(const cv::Mat& image, int largeur, int hauteur, double coefficient,
+                    ModeBord mode = BORD_REFLET_101, double valeurConstante = 0.0);
+
+cv::Mat moyenneBoite(const cv::Mat& image, int largeur, int hauteur, ModeBord mode = BORD_REFLET_101,
+                     double valeurConstante = 0.0);
+
+// Moyenne et variance (CV_32F) de la fenêtre ; les sommes sont entières et exactes
+void varianceBoite(const cv::Mat& image, cv::Mat& moyenne, cv::Mat& variance, int largeur, int hauteur,
+                   ModeBord mode = BORD_REFLET_101, double valeurConstante = 0.0);
+
+#endif
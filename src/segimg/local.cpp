@@ -0,0 +1,148 @@
+#include "local.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+// Découpe l'image en bandes de lignes, une par thread : chaque bande recompte ses
+// 2 rayon + 1 premières lignes, on ne la découpe donc pas plus finement. Les compteurs
+// 16 bits suffisent jusqu'à un rayon de 127 et divisent par deux la mémoire parcourue.
+template<typename Requete>
+static void parcourirEnBandes(const cv::Mat& image, int rayon, ModeBord mode, int nombreThreads,
+                              const Requete& requete) {
+    int cote = 2 * rayon + 1;
+    bool compteurs16 = cote * cote <= std::numeric_limits<uint16_t>::max();
+    int nbBandes = std::min(nombreThreadsEffectif(nombreThreads), image.rows);
+    executerEnParallele(nbBandes, nombreThreads, [&](int bande) {
+        int debut = image.rows * bande / nbBandes;
+        int fin = image.rows * (bande + 1) / nbBandes;
+        // Chaque bande a sa copie de la requête, qui garde ses propres lignes de sortie
+        Requete copie = requete;
+        if (compteurs16) {
+            parcourirFenetres<uint16_t>(image, rayon, debut, fin, mode, copie);
+        } else {
+            parcourirFenetres<uint32_t>(image, rayon, debut, fin, mode, copie);
+        }
+    });
+}
+
+static bool verifierFenetre(const cv::Mat& image, int rayon) {
+    if (image.type() != CV_8UC1 || image.empty()) {
+        std::cerr << "Les traitements locaux attendent une image en niveaux de gris 8 bits." << std::endl;
+        return false;
+    }
+    if (rayon < 0 || rayon > 4096) {
+        std::cerr << "Le rayon de la fenêtre doit être compris entre 0 et 4096." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+struct EgalisationLocale {
+    cv::Mat& sortie;
+    // Ligne de sortie du pixel en cours, relue seulement quand y change
+    int y;
+    uchar* ligne;
+
+    template<typename Compteur>
+    void operator()(const HistogrammeFenetre<Compteur>& fenetre, int yPixel, int x, uchar valeur) {
+        if (yPixel != y) {
+            y = yPixel;
+            ligne = sortie.ptr<uchar>(y);
+        }
+        ligne[x] = static_cast<uchar>(255ull * fenetre.rang(valeur) / fenetre.total);
+    }
+};
+
+void egaliserHistogrammeLocal(const cv::Mat& image, cv::Mat& resultat, int rayon, int nombreThreads) {
+    if (!verifierFenetre(image, rayon)) {
+        return;
+    }
+
+    // Nouvelle image : image et resultat peuvent être la même matrice
+    cv::Mat sortie(image.size(), CV_8UC1);
+    EgalisationLocale egalisation = {sortie, -1, 0};
+    parcourirEnBandes(image, rayon, BORD_REFLET_101, nombreThreads, egalisation);
+    resultat = sortie;
+}
+
+void egaliserHistogrammeLocal(const cv::Mat& image, cv::Mat& resultat, int rayon) {
+    egaliserHistogrammeLocal(image, resultat, rayon, nombreThreadsParDefaut());
+}
+
+struct StatistiquesLocales {
+    cv::Mat& moyenne;
+    cv::Mat& ecartType;
+    // Lignes de sortie du pixel en cours, relues seulement quand y change
+    int y;
+    float* ligneMoyenne;
+    float* ligneEcartType;
+
+    template<typename Compteur>
+    void operator()(const HistogrammeFenetre<Compteur>& fenetre, int yPixel, int x, uchar) {
+        if (yPixel != y) {
+            y = yPixel;
+            ligneMoyenne = moyenne.ptr<float>(y);
+            ligneEcartType = ecartType.ptr<float>(y);
+        }
+        // Les sommes sont entières et exactes ; seule la variance passe en double
+        double m = static_cast<double>(fenetre.somme) / fenetre.total;
+        double variance = static_cast<double>(fenetre.sommeCarres) / fenetre.total - m * m;
+        ligneMoyenne[x] = static_cast<float>(m);
+        ligneEcartType[x] = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+    }
+};
+
+void statistiquesLocales(const cv::Mat& image, cv::Mat& moyenne, cv::Mat& ecartType, int rayon, int nombreThreads) {
+    if (!verifierFenetre(image, rayon)) {
+        return;
+    }
+
+    cv::Mat sortieMoyenne(image.size(), CV_32FC1);
+    cv::Mat sortieEcartType(image.size(), CV_32FC1);
+    StatistiquesLocales statistiques = {sortieMoyenne, sortieEcartType, -1, 0, 0};
+    parcourirEnBandes(image, rayon, BORD_REFLET_101, nombreThreads, statistiques);
+    moyenne = sortieMoyenne;
+    ecartType = sortieEcartType;
+}
+
+void statistiquesLocales(const cv::Mat& image, cv::Mat& moyenne, cv::Mat& ecartType, int rayon) {
+    statistiquesLocales(image, moyenne, ecartType, rayon, nombreThreadsParDefaut());
+}
+
+struct FiltreRang {
+    cv::Mat& sortie;
+    double quantile;
+    // Ligne de sortie du pixel en cours, relue seulement quand y change
+    int y;
+    uchar* ligne;
+
+    template<typename Compteur>
+    void operator()(const HistogrammeFenetre<Compteur>& fenetre, int yPixel, int x, uchar) {
+        if (yPixel != y) {
+            y = yPixel;
+            ligne = sortie.ptr<uchar>(y);
+        }
+        uint32_t rang = static_cast<uint32_t>(quantile * (fenetre.total - 1) + 0.5);
+        ligne[x] = static_cast<uchar>(fenetre.valeurDeRang(rang));
+    }
+};
+
+void filtreRang(const cv::Mat& image, cv::Mat& resultat, int rayon, double quantile, ModeBord mode,
+                int nombreThreads) {
+    if (!verifierFenetre(image, rayon)) {
+        return;
+    }
+    if (mode == BORD_ZERO_CADRE || mode == BORD_CONSTANT || !(quantile >= 0.0 && quantile <= 1.0)) {
+        std::cerr << "Le filtre de rang attend un quantile dans [0, 1] et un bord par reflet, répliqué ou cyclique."
+                  << std::endl;
+        return;
+    }
+
+    cv::Mat sortie(image.size(), CV_8UC1);
+    FiltreRang filtre = {sortie, quantile, -1, 0};
+    parcourirEnBandes(image, rayon, mode, nombreThreads, filtre);
+    resultat = sortie;
+}
@@ -0,0 +1,32 @@
+#ifndef SEGIMG_LOCAL_HPP
+#define SEGIMG_LOCAL_HPP
+
+#include <opencv2/opencv.hpp>
+#include "filtre.hpp"
+
+// Traitements locaux : chaque pixel est traité selon l'histogramme de la fenêtre de
+// côté 2 rayon + 1 centrée sur lui (bords par reflet). L'histogramme glisse avec la
+// fenêtre (voir parcourirFenetres) : le coût par pixel ne dépend pas du rayon, et des
+// rayons de 31 à 63 restent utilisables sur des images de plusieurs mégapixels. Les
+// bandes de lignes sont réparties sur nombreThreads threads (0 = un par coeur).
+
+// Égalisation locale d'une image 8 bits en niveaux de gris : chaque pixel prend la
+// valeur 255 x (pixels de sa fenêtre <= lui) / (pixels de la fenêtre), tronquée,
+// comme l'égalisation globale de egaliseHist
+void egaliserHistogrammeLocal(const cv::Mat& image, cv::Mat& resultat, int rayon, int nombreThreads);
+
+void egaliserHistogrammeLocal(const cv::Mat& image, cv::Mat& resultat, int rayon);
+
+// Moyenne et écart-type (CV_32F) de la fenêtre de chaque pixel d'une image 8 bits en
+// niveaux de gris
+void statistiquesLocales(const cv::Mat& image, cv::Mat& moyenne, cv::Mat& ecartType, int rayon, int nombreThreads);
+
+void statistiquesLocales(const cv::Mat& image, cv::Mat& moyenne, cv::Mat& ecartType, int rayon);
+
+// Filtre de rang d'une image 8 bits en niveaux de gris : chaque pixel prend la valeur
+// placée au quantile donné parmi ceux de sa fenêtre (0 = minimum, 0.5 = médiane,
+// 1 = maximum). Bords par reflet, répliqués ou cycliques (voir ModeBord).
+void filtreRang(const cv::Mat& image, cv::Mat& resultat, int rayon, double quantile, ModeBord mode,
+                int nombreThreads);
+
+#endif
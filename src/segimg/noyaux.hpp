@@ -0,0 +1,941 @@
+#ifndef SEGIMG_NOYAUX_HPP
+#define SEGIMG_NOYAUX_HPP
+
+// Noyaux de calcul appelés dans les boucles chaudes. Ils restent dans un en-tête,
+// en inline ou en template, pour que le compilateur puisse les inliner et les
+// spécialiser dans chaque unité de compilation qui les utilise.
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "filtre.hpp"
+#include "pixels.hpp"
+
+// Nombre de sous-histogrammes utilisés par calculerHistogrammeBrut
+const int NB_SOUS_HISTOGRAMMES = 4;
+
+// Calcule l'histogramme d'une image 8 bits dans un tableau de 256 compteurs entiers.
+// On parcourt l'image ligne par ligne avec des pointeurs, en lisant 8 pixels à la fois
+// dans un mot de 64 bits. Les pixels sont répartis sur plusieurs sous-histogrammes :
+// deux pixels voisins de même intensité n'incrémentent donc jamais la même case à la
+// suite, ce qui évite d'attendre la fin de l'écriture précédente avant de relire la case.
+inline void calculerHistogrammeBrut(const cv::Mat& image, uint32_t histo[256]) {
+    std::memset(histo, 0, 256 * sizeof(uint32_t));
+
+    if (image.type() != CV_8UC1) {
+        std::cerr << "L'histogramme rapide attend une image en niveaux de gris 8 bits." << std::endl;
+        return;
+    }
+
+    // Les sous-histogrammes restent sur la pile (4 Ko)
+    uint32_t sousHisto[NB_SOUS_HISTOGRAMMES][256];
+    std::memset(sousHisto, 0, sizeof(sousHisto));
+
+    // Si l'image est continue en mémoire on la parcourt comme une seule grande ligne
+    int nbLignes = image.rows;
+    int nbColonnes = image.cols;
+    if (image.isContinuous()) {
+        nbColonnes *= nbLignes;
+        nbLignes = 1;
+    }
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const uchar* ligne = image.ptr<uchar>(i);
+        int j = 0;
+
+        // Boucle principale : 8 pixels par itération
+        for (; j + 8 <= nbColonnes; j += 8) {
+            uint64_t mot;
+            std::memcpy(&mot, ligne + j, sizeof(mot));
+            ++sousHisto[0][mot & 0xFF];
+            ++sousHisto[1][(mot >> 8) & 0xFF];
+            ++sousHisto[2][(mot >> 16) & 0xFF];
+            ++sousHisto[3][(mot >> 24) & 0xFF];
+            ++sousHisto[0][(mot >> 32) & 0xFF];
+            ++sousHisto[1][(mot >> 40) & 0xFF];
+            ++sousHisto[2][(mot >> 48) & 0xFF];
+            ++sousHisto[3][mot >> 56];
+        }
+
+        // Les derniers pixels de la ligne
+        for (; j < nbColonnes; ++j) {
+            ++sousHisto[0][ligne[j]];
+        }
+    }
+
+    // On fusionne les sous-histogrammes
+    for (int k = 0; k < 256; ++k) {
+        histo[k] = sousHisto[0][k] + sousHisto[1][k] + sousHisto[2][k] + sousHisto[3][k];
+    }
+}
+
+// Case d'histogramme d'une valeur. Chaque indexeur dit s'il peut renvoyer -1 (valeur
+// hors de l'histogramme) : sinon la boucle de comptage n'a pas de test.
+struct IndexeurDecalage {
+    static const bool peutSortir = false;
+    int decalage;  // cases de 2^decalage valeurs, pour un type entier
+
+    explicit IndexeurDecalage(int decalage) : decalage(decalage) {}
+    int operator()(int valeur) const { return valeur >> decalage; }
+};
+
+// Cases de même largeur sur [borneMin, borneMax[. Si Borner, les valeurs hors de
+// l'intervalle vont dans la première ou la dernière case ; sinon elles sont ignorées,
+// comme dans cv::calcHist.
+template<bool Borner>
+struct IndexeurAffine {
+    static const bool peutSortir = !Borner;
+    double borneMin;
+    double echelle;
+    int nbBins;
+
+    IndexeurAffine(int nbBins, double borneMin, double borneMax)
+        : borneMin(borneMin), echelle(nbBins / (borneMax - borneMin)), nbBins(nbBins) {}
+
+    int operator()(double valeur) const {
+        double position = (valeur - borneMin) * echelle;
+        if (Borner) {
+            return position < 1.0 ? 0 : (position >= nbBins - 1 ? nbBins - 1 : static_cast<int>(position));
+        }
+        // Le test est écrit pour qu'une valeur NaN soit ignorée
+        return position >= 0.0 && position < nbBins ? static_cast<int>(position) : -1;
+    }
+};
+
+// Histogramme de chaque canal d'une image T à Canaux canaux entrelacés : histos[c *
+// nbBins + k] compte les valeurs du canal c tombées dans la case k
+template<typename T, int Canaux, typename Indexeur>
+void calculerHistogrammeCanauxBrut(const cv::Mat& image, uint32_t* histos, int nbBins, const Indexeur& indexeur) {
+    std::memset(histos, 0, Canaux * nbBins * sizeof(uint32_t));
+
+    int nbLignes, nbValeurs;
+    dimensionsParcours(image, nbLignes, nbValeurs);
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const T* ligne = image.ptr<T>(i);
+        for (int j = 0; j < nbValeurs; j += Canaux) {
+            for (int c = 0; c < Canaux; ++c) {
+                int k = indexeur(ligne[j + c]);
+                if (!Indexeur::peutSortir || k >= 0) {
+                    ++histos[c * nbBins + k];
+                }
+            }
+        }
+    }
+}
+
+// Second niveau de l'histogramme 16 bits : compte les valeurs du canal `canal` dans les
+// cases des blocs occupés. blocs[b] est le rang du bloc b dans compteurs ; le premier
+// niveau garantit que toute valeur de l'image tombe dans un bloc occupé.
+template<int Canaux>
+void calculerHistogramme16Brut(const cv::Mat& image, int canal, int decalage, const int16_t blocs[256],
+                               uint32_t* compteurs, int taille) {
+    std::memset(compteurs, 0, taille * sizeof(uint32_t));
+
+    int nbLignes, nbValeurs;
+    dimensionsParcours(image, nbLignes, nbValeurs);
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const ushort* ligne = image.ptr<ushort>(i) + canal;
+        for (int j = 0; j < nbValeurs; j += Canaux) {
+            int indiceCase = ligne[j] >> decalage;
+            ++compteurs[(blocs[indiceCase >> 8] << 8) | (indiceCase & 0xFF)];
+        }
+    }
+}
+
+// Applique au canal `canal` une table 16 bits rangée comme un Histogramme16 : une
+// entrée par case des blocs occupés. source et destination peuvent être la même image.
+template<int Canaux>
+void appliquerTable16(const cv::Mat& image, cv::Mat& resultat, int canal, int decalage, const int16_t blocs[256],
+                      const ushort* table) {
+    int nbLignes, nbValeurs;
+    dimensionsParcours(image, resultat, nbLignes, nbValeurs);
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const ushort* source = image.ptr<ushort>(i) + canal;
+        ushort* destination = resultat.ptr<ushort>(i) + canal;
+        for (int j = 0; j < nbValeurs; j += Canaux) {
+            int indiceCase = source[j] >> decalage;
+            destination[j] = table[(blocs[indiceCase >> 8] << 8) | (indiceCase & 0xFF)];
+        }
+    }
+}
+
+// Valeurs minimale et maximale de chaque canal. Sur un seul canal, la réduction se fait
+// dans deux variables locales, sans dépendance entre itérations autre que le min et le
+// max : le compilateur la vectorise (pminub/pmaxub en 8 bits, 16 pixels à la fois).
+template<typename T, int Canaux>
+void minMaxCanaux(const cv::Mat& image, double minVal[], double maxVal[]) {
+    T minimum[Canaux], maximum[Canaux];
+    for (int c = 0; c < Canaux; ++c) {
+        minimum[c] = std::numeric_limits<T>::max();
+        maximum[c] = std::numeric_limits<T>::lowest();
+    }
+
+    int nbLignes, nbValeurs;
+    dimensionsParcours(image, nbLignes, nbValeurs);
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const T* ligne = image.ptr<T>(i);
+        if (Canaux == 1) {
+            T minLigne = minimum[0];
+            T maxLigne = maximum[0];
+            for (int j = 0; j < nbValeurs; ++j) {
+                minLigne = ligne[j] < minLigne ? ligne[j] : minLigne;
+                maxLigne = ligne[j] > maxLigne ? ligne[j] : maxLigne;
+            }
+            minimum[0] = minLigne;
+            maximum[0] = maxLigne;
+            continue;
+        }
+        for (int j = 0; j < nbValeurs; j += Canaux) {
+            for (int c = 0; c < Canaux; ++c) {
+                minimum[c] = std::min(minimum[c], ligne[j + c]);
+                maximum[c] = std::max(maximum[c], ligne[j + c]);
+            }
+        }
+    }
+
+    for (int c = 0; c < Canaux; ++c) {
+        minVal[c] = minimum[c];
+        maxVal[c] = maximum[c];
+    }
+}
+
+// Applique une table de correspondance par canal : destination = tables[c * nbBins +
+// indexeur(source)]. source et destination peuvent être la même image.
+template<typename T, int Canaux, typename Indexeur>
+void appliquerTableCanaux(const cv::Mat& image, cv::Mat& resultat, const T* tables, int nbBins, const Indexeur& indexeur) {
+    int nbLignes, nbValeurs;
+    dimensionsParcours(image, resultat, nbLignes, nbValeurs);
+
+    for (int i = 0; i < nbLignes; ++i) {
+        const T* source = image.ptr<T>(i);
+        T* destination = resultat.ptr<T>(i);
+        for (int j = 0; j < nbValeurs; j += Canaux) {
+            for (int c = 0; c < Canaux; ++c) {
+                destination[j + c] = tables[c * nbBins + indexeur(source[j + c])];
+            }
+        }
+    }
+}
+
+// Les boucles internes de la convolution : un seul coefficient appliqué à toute une
+// ligne contiguë. Sans dépendance entre itérations, le compilateur les vectorise.
+template<typename Acc, typename T>
+void accumulerLigne(const T* source, Acc* accumulateur, int longueur, Acc poids) {
+    for (int x = 0; x < longueur; ++x) {
+        accumulateur[x] += poids * static_cast<Acc>(source[x]);
+    }
+}
+
+template<typename Acc>
+void accumulerTampon(const Acc* source, Acc* accumulateur, int longueur, Acc poids) {
+    for (int x = 0; x < longueur; ++x) {
+        accumulateur[x] += poids * source[x];
+    }
+}
+
+// Indice réel d'une position p (éventuellement hors de [0, longueur[) selon le mode
+// de bord, ou -1 si la position prend la valeur constante
+inline int indiceBord(int p, int longueur, ModeBord mode) {
+    switch (mode) {
+        case BORD_REPLIQUE:
+            return cv::borderInterpolate(p, longueur, cv::BORDER_REPLICATE);
+        case BORD_REFLET:
+            return cv::borderInterpolate(p, longueur, cv::BORDER_REFLECT);
+        case BORD_REFLET_101:
+            return cv::borderInterpolate(p, longueur, cv::BORDER_REFLECT_101);
+        case BORD_CYCLIQUE:
+            return cv::borderInterpolate(p, longueur, cv::BORDER_WRAP);
+        default:
+            return (p >= 0 && p < longueur) ? p : -1;
+    }
+}
+
+// Pointeur vers la ligne y de l'image, ou vers la ligne constante si y sort de l'image
+template<typename T>
+const T* pointeurLigne(const cv::Mat& image, int y, ModeBord mode, const std::vector<T>& ligneConstante) {
+    int indice = indiceBord(y, image.rows, mode);
+    return indice < 0 ? &ligneConstante[0] : image.ptr<T>(indice);
+}
+
+// Les accumulateurs en virgule fixe sont arrondis au plus proche, ceux en double aussi
+inline int32_t arrondirAccumulateur(int32_t accumulateur, int bits) {
+    return (accumulateur + ((1 << bits) >> 1)) >> bits;
+}
+
+inline double arrondirAccumulateur(double accumulateur, int) {
+    return std::floor(accumulateur + 0.5);
+}
+
+inline float arrondirAccumulateur(float accumulateur, int) {
+    return std::floor(accumulateur + 0.5f);
+}
+
+inline float accumulateurVersFlottant(int32_t accumulateur, float echelle) {
+    return static_cast<float>(accumulateur) * echelle;
+}
+
+inline float accumulateurVersFlottant(double accumulateur, float) {
+    return static_cast<float>(accumulateur);
+}
+
+inline float accumulateurVersFlottant(float accumulateur, float) {
+    return accumulateur;
+}
+
+template<OperationSortie Operation, typename T>
+inline T appliquerOperation(T valeur) {
+    if (Operation == SORTIE_VALEUR_ABSOLUE) {
+        return valeur < T(0) ? -valeur : valeur;
+    }
+    if (Operation == SORTIE_DECALAGE_128) {
+        return valeur + T(128);
+    }
+    return valeur;
+}
+
+template<typename Sortie, bool Saturer, typename T>
+inline Sortie convertirSortie(T valeur) {
+    return Saturer ? cv::saturate_cast<Sortie>(valeur) : static_cast<Sortie>(static_cast<int64_t>(valeur));
+}
+
+// Ramène une ligne d'accumulateurs vers le type de sortie. L'opération et la
+// conversion sont des paramètres de template : la boucle n'a aucun test.
+template<typename Sortie, OperationSortie Operation, bool Saturer, typename Acc>
+void ecrireLigneType(const Acc* accumulateur, Sortie* destination, int longueur, int bits) {
+    if (std::numeric_limits<Sortie>::is_integer) {
+        for (int x = 0; x < longueur; ++x) {
+            destination[x] = convertirSortie<Sortie, Saturer>(
+                appliquerOperation<Operation>(arrondirAccumulateur(accumulateur[x], bits)));
+        }
+    } else {
+        float echelle = std::ldexp(1.0f, -bits);
+        for (int x = 0; x < longueur; ++x) {
+            destination[x] = static_cast<Sortie>(
+                appliquerOperation<Operation>(accumulateurVersFlottant(accumulateur[x], echelle)));
+        }
+    }
+}
+
+template<typename Sortie, typename Acc>
+void ecrireLigneProfondeur(const Acc* accumulateur, Sortie* destination, int longueur, int bits,
+                           const OptionsFiltre& options) {
+    // Les sorties flottantes ne sont jamais tronquées
+    bool saturer = options.saturer || !std::numeric_limits<Sortie>::is_integer;
+    switch (options.operation) {
+        case SORTIE_VALEUR_ABSOLUE:
+            saturer ? ecrireLigneType<Sortie, SORTIE_VALEUR_ABSOLUE, true>(accumulateur, destination, longueur, bits)
+                    : ecrireLigneType<Sortie, SORTIE_VALEUR_ABSOLUE, false>(accumulateur, destination, longueur, bits);
+            break;
+        case SORTIE_DECALAGE_128:
+            saturer ? ecrireLigneType<Sortie, SORTIE_DECALAGE_128, true>(accumulateur, destination, longueur, bits)
+                    : ecrireLigneType<Sortie, SORTIE_DECALAGE_128, false>(accumulateur, destination, longueur, bits);
+            break;
+        default:
+            saturer ? ecrireLigneType<Sortie, SORTIE_BRUTE, true>(accumulateur, destination, longueur, bits)
+                    : ecrireLigneType<Sortie, SORTIE_BRUTE, false>(accumulateur, destination, longueur, bits);
+            break;
+    }
+}
+
+// Écrit `longueur` accumulateurs dans la ligne y du résultat, à partir de la valeur x
+// (x = colonne * nombre de canaux)
+template<typename Acc>
+void ecrireLigne(const Acc* accumulateur, cv::Mat& resultat, int y, int x, int longueur, int bits,
+                 const OptionsFiltre& options) {
+    switch (resultat.depth()) {
+        case CV_16U:
+            ecrireLigneProfondeur(accumulateur, resultat.ptr<ushort>(y) + x, longueur, bits, options);
+            break;
+        case CV_16S:
+            ecrireLigneProfondeur(accumulateur, resultat.ptr<short>(y) + x, longueur, bits, options);
+            break;
+        case CV_32F:
+            ecrireLigneProfondeur(accumulateur, resultat.ptr<float>(y) + x, longueur, bits, options);
+            break;
+        default:
+            ecrireLigneProfondeur(accumulateur, resultat.ptr<uchar>(y) + x, longueur, bits, options);
+            break;
+    }
+}
+
+// Filtre séparable : pour chaque ligne de sortie, une passe verticale accumule les
+// lignes sources dans un tampon de la largeur de l'image, puis une passe horizontale
+// filtre ce tampon. Les lignes hors de l'image sont résolues une fois par ligne dans
+// un tableau de pointeurs, et les colonnes hors de l'image en complétant les deux
+// bouts du tampon : la boucle horizontale n'a donc jamais de test de bord. Les canaux
+// sont entrelacés : un décalage d'une colonne vaut Canaux valeurs, et chaque canal
+// est filtré séparément sans boucle supplémentaire.
+template<typename Acc, typename T, int Canaux>
+void convolutionSeparableType(const cv::Mat& image, const std::vector<Acc>& colonne, const std::vector<Acc>& ligne,
+                              int bits, const OptionsFiltre& options, cv::Mat& resultat) {
+    int rayonY = static_cast<int>(colonne.size()) / 2;
+    int rayonX = static_cast<int>(ligne.size()) / 2;
+    ModeBord mode = options.bord;
+    bool cadre = mode == BORD_ZERO_CADRE;
+
+    // Lignes de sortie calculées, et première colonne calculée
+    int yDebut = cadre ? rayonY : 0;
+    int yFin = cadre ? image.rows - rayonY : image.rows;
+    int xDebut = cadre ? rayonX : 0;
+    int largeurSortie = cadre ? image.cols - 2 * rayonX : image.cols;
+
+    std::vector<T> ligneConstante(image.cols * Canaux, cv::saturate_cast<T>(options.valeurConstante));
+    std::vector<const T*> lignes(colonne.size());
+
+    // tampon[(rayonX + x) * Canaux + c] contient la passe verticale du canal c de la colonne x
+    std::vector<Acc> tampon((image.cols + 2 * rayonX) * Canaux);
+    std::vector<Acc> accumulateur(largeurSortie * Canaux);
+
+    // Réponse de la passe verticale sur une colonne constante
+    Acc colonneConstante = Acc(0);
+    for (size_t k = 0; k < colonne.size(); ++k) {
+        colonneConstante += colonne[k] * static_cast<Acc>(ligneConstante[0]);
+    }
+
+    for (int y = yDebut; y < yFin; ++y) {
+        for (size_t k = 0; k < colonne.size(); ++k) {
+            lignes[k] = pointeurLigne(image, y - rayonY + static_cast<int>(k), mode, ligneConstante);
+        }
+
+        // Passe verticale sur toute la largeur
+        std::fill(tampon.begin(), tampon.end(), Acc(0));
+        for (size_t k = 0; k < colonne.size(); ++k) {
+            if (colonne[k] != Acc(0)) {
+                accumulerLigne(lignes[k], &tampon[rayonX * Canaux], image.cols * Canaux, colonne[k]);
+            }
+        }
+
+        // On complète les colonnes situées hors de l'image
+        if (!cadre) {
+            for (int i = 1; i <= rayonX; ++i) {
+                int gauche = indiceBord(-i, image.cols, mode);
+                int droite = indiceBord(image.cols - 1 + i, image.cols, mode);
+                for (int c = 0; c < Canaux; ++c) {
+                    tampon[(rayonX - i) * Canaux + c] =
+                        gauche < 0 ? colonneConstante : tampon[(rayonX + gauche) * Canaux + c];
+                    tampon[(rayonX + image.cols - 1 + i) * Canaux + c] =
+                        droite < 0 ? colonneConstante : tampon[(rayonX + droite) * Canaux + c];
+                }
+            }
+        }
+
+        // Passe horizontale
+        std::fill(accumulateur.begin(), accumulateur.end(), Acc(0));
+        for (size_t k = 0; k < ligne.size(); ++k) {
+            if (ligne[k] != Acc(0)) {
+                accumulerTampon(&tampon[(xDebut + k) * Canaux], &accumulateur[0], largeurSortie * Canaux, ligne[k]);
+            }
+        }
+
+        ecrireLigne(&accumulateur[0], resultat, y, xDebut * Canaux, largeurSortie * Canaux, bits, options);
+    }
+}
+
+// Filtre quelconque : à l'intérieur de l'image, chaque coefficient non nul est appliqué
+// à une ligne entière sans aucun test. Les colonnes de bord, où le filtre déborde, sont
+// calculées à part, pixel par pixel, avec une table d'indices de colonnes.
+template<typename Acc, typename T, int Canaux>
+void convolutionGeneraleType(const cv::Mat& image, const std::vector<Acc>& coefficients, int hauteur, int largeur,
+                             int bits, const OptionsFiltre& options, cv::Mat& resultat) {
+    int rayonY = hauteur / 2;
+    int rayonX = largeur / 2;
+    ModeBord mode = options.bord;
+    bool cadre = mode == BORD_ZERO_CADRE;
+
+    int yDebut = cadre ? rayonY : 0;
+    int yFin = cadre ? image.rows - rayonY : image.rows;
+    int largeurInterieure = std::max(image.cols - 2 * rayonX, 0);
+
+    std::vector<T> ligneConstante(image.cols * Canaux, cv::saturate_cast<T>(options.valeurConstante));
+    std::vector<const T*> lignes(hauteur);
+    std::vector<Acc> accumulateur(largeurInterieure * Canaux);
+
+    // colonnes[x + n] : colonne lue pour la sortie x et le coefficient n (-1 = constante)
+    std::vector<int> colonnes(image.cols + 2 * rayonX);
+    for (size_t p = 0; p < colonnes.size(); ++p) {
+        colonnes[p] = indiceBord(static_cast<int>(p) - rayonX, image.cols, mode);
+    }
+
+    // Colonnes de bord : [0, finGauche[ et [debutDroite, largeur de l'image[
+    int finGauche = std::min(rayonX, image.cols);
+    int debutDroite = std::max(image.cols - rayonX, finGauche);
+
+    for (int y = yDebut; y < yFin; ++y) {
+        for (int m = 0; m < hauteur; ++m) {
+            lignes[m] = pointeurLigne(image, y - rayonY + m, mode, ligneConstante);
+        }
+
+        // Intérieur de la ligne
+        if (largeurInterieure > 0) {
+            std::fill(accumulateur.begin(), accumulateur.end(), Acc(0));
+            for (int m = 0; m < hauteur; ++m) {
+                for (int n = 0; n < largeur; ++n) {
+                    Acc poids = coefficients[m * largeur + n];
+                    if (poids != Acc(0)) {
+                        accumulerLigne(lignes[m] + n * Canaux, &accumulateur[0], largeurInterieure * Canaux, poids);
+                    }
+                }
+            }
+            ecrireLigne(&accumulateur[0], resultat, y, rayonX * Canaux, largeurInterieure * Canaux, bits, options);
+        }
+
+        if (cadre) {
+            continue;
+        }
+
+        // Colonnes de bord
+        for (int x = 0; x < image.cols; ++x) {
+            if (x == finGauche) {
+                x = debutDroite;
+                if (x >= image.cols) {
+                    break;
+                }
+            }
+
+            Acc somme[Canaux];
+            std::fill(somme, somme + Canaux, Acc(0));
+            for (int m = 0; m < hauteur; ++m) {
+                for (int n = 0; n < largeur; ++n) {
+                    int colonneSource = colonnes[x + n];
+                    Acc poids = coefficients[m * largeur + n];
+                    for (int c = 0; c < Canaux; ++c) {
+                        T valeur = colonneSource < 0 ? ligneConstante[0] : lignes[m][colonneSource * Canaux + c];
+                        somme[c] += poids * static_cast<Acc>(valeur);
+                    }
+                }
+            }
+            ecrireLigne(somme, resultat, y, x * Canaux, Canaux, bits, options);
+        }
+    }
+}
+
+// Ligne y (éventuellement hors de l'image) d'une image 8 bits, prolongée de rayonX
+// colonnes de chaque côté selon le mode de bord
+inline void prolongerLigne(const cv::Mat& image, int y, int rayonX, ModeBord mode, uchar constante,
+                           uchar* destination) {
+    int ligneSource = indiceBord(y, image.rows, mode);
+    if (ligneSource < 0) {
+        std::fill(destination, destination + image.cols + 2 * rayonX, constante);
+        return;
+    }
+    const uchar* source = image.ptr<uchar>(ligneSource);
+    std::copy(source, source + image.cols, destination + rayonX);
+    for (int i = 1; i <= rayonX; ++i) {
+        int gauche = indiceBord(-i, image.cols, mode);
+        int droite = indiceBord(image.cols - 1 + i, image.cols, mode);
+        destination[rayonX - i] = gauche < 0 ? constante : source[gauche];
+        destination[rayonX + image.cols - 1 + i] = droite < 0 ? constante : source[droite];
+    }
+}
+
+// Image 8 bits prolongée de rayonX colonnes et rayonY lignes de chaque côté selon le
+// mode de bord, pour que les noyaux lisent toute leur fenêtre sans test
+inline cv::Mat prolongerImage(const cv::Mat& image, int rayonX, int rayonY, ModeBord mode, double valeurConstante) {
+    cv::Mat etendue(image.rows + 2 * rayonY, image.cols + 2 * rayonX, CV_8UC1);
+    for (int y = 0; y < etendue.rows; ++y) {
+        prolongerLigne(image, y - rayonY, rayonX, mode, cv::saturate_cast<uchar>(valeurConstante),
+                       etendue.ptr<uchar>(y));
+    }
+    return etendue;
+}
+
+// Sommes glissantes de colonnes : chaque colonne ajoute la ligne qui entre dans la
+// fenêtre et retire celle qui en sort (ainsi que leurs carrés si colonnesCarres n'est
+// pas nul). Somme est non signé : les calculs se font modulo 2^32 ou 2^64 et restent
+// exacts tant que la somme d'une colonne tient dans Somme.
+template<typename Somme>
+inline void glisserColonnes(const uchar* entrante, const uchar* sortante, int largeur, Somme* colonnes,
+                            Somme* colonnesCarres) {
+    for (int x = 0; x < largeur; ++x) {
+        colonnes[x] = static_cast<Somme>(colonnes[x] + entrante[x] - sortante[x]);
+    }
+    if (colonnesCarres != 0) {
+        for (int x = 0; x < largeur; ++x) {
+            uint32_t e = entrante[x];
+            uint32_t s = sortante[x];
+            colonnesCarres[x] = static_cast<Somme>(colonnesCarres[x] + e * e - s * s);
+        }
+    }
+}
+
+// Sommes des fenêtres de largeur colonnes le long d'une ligne de sommes de colonnes :
+// un cumul, puis une différence sans dépendance entre pixels
+template<typename Somme>
+inline void sommerFenetresLigne(const Somme* colonnes, int nbFenetres, int largeur, Somme* cumul, Somme* sommes) {
+    cumul[0] = 0;
+    for (int x = 0; x < nbFenetres + largeur - 1; ++x) {
+        cumul[x + 1] = static_cast<Somme>(cumul[x] + colonnes[x]);
+    }
+    for (int x = 0; x < nbFenetres; ++x) {
+        sommes[x] = static_cast<Somme>(cumul[x + largeur] - cumul[x]);
+    }
+}
+
+// Échange a et b si besoin, pour que a <= b : un min et un max, sans branchement
+inline void trierPaire(uchar& a, uchar& b) {
+    uchar plusPetit = std::min(a, b);
+    b = std::max(a, b);
+    a = plusPetit;
+}
+
+// Médiane 3x3 d'une ligne par un réseau de 19 échanges (Paeth) : lignes[m] pointe sur
+// la ligne m de la fenêtre, prolongée d'une colonne à gauche. Chaque pixel suit les
+// mêmes échanges, sans branchement : le compilateur traite 16 ou 32 pixels à la fois.
+inline void medianeLigne3x3(const uchar* const lignes[3], uchar* sortie, int largeur) {
+    const uchar* l0 = lignes[0];
+    const uchar* l1 = lignes[1];
+    const uchar* l2 = lignes[2];
+    for (int x = 0; x < largeur; ++x) {
+        uchar p[9] = {l0[x], l0[x + 1], l0[x + 2], l1[x], l1[x + 1], l1[x + 2], l2[x], l2[x + 1], l2[x + 2]};
+        trierPaire(p[1], p[2]); trierPaire(p[4], p[5]); trierPaire(p[7], p[8]); trierPaire(p[0], p[1]);
+        trierPaire(p[3], p[4]); trierPaire(p[6], p[7]); trierPaire(p[1], p[2]); trierPaire(p[4], p[5]);
+        trierPaire(p[7], p[8]); trierPaire(p[0], p[3]); trierPaire(p[5], p[8]); trierPaire(p[4], p[7]);
+        trierPaire(p[3], p[6]); trierPaire(p[1], p[4]); trierPaire(p[2], p[5]); trierPaire(p[4], p[7]);
+        trierPaire(p[4], p[2]); trierPaire(p[6], p[4]); trierPaire(p[4], p[2]);
+        sortie[x] = p[4];
+    }
+}
+
+// Médiane 5x5 par un réseau de 99 échanges (Devillard), même principe
+inline void medianeLigne5x5(const uchar* const lignes[5], uchar* sortie, int largeur) {
+    const uchar* l0 = lignes[0];
+    const uchar* l1 = lignes[1];
+    const uchar* l2 = lignes[2];
+    const uchar* l3 = lignes[3];
+    const uchar* l4 = lignes[4];
+    for (int x = 0; x < largeur; ++x) {
+        uchar p[25] = {l0[x], l0[x + 1], l0[x + 2], l0[x + 3], l0[x + 4],
+                       l1[x], l1[x + 1], l1[x + 2], l1[x + 3], l1[x + 4],
+                       l2[x], l2[x + 1], l2[x + 2], l2[x + 3], l2[x + 4],
+                       l3[x], l3[x + 1], l3[x + 2], l3[x + 3], l3[x + 4],
+                       l4[x], l4[x + 1], l4[x + 2], l4[x + 3], l4[x + 4]};
+        trierPaire(p[0], p[1]); trierPaire(p[3], p[4]); trierPaire(p[2], p[4]); trierPaire(p[2], p[3]);
+        trierPaire(p[6], p[7]); trierPaire(p[5], p[7]); trierPaire(p[5], p[6]); trierPaire(p[9], p[10]);
+        trierPaire(p[8], p[10]); trierPaire(p[8], p[9]); trierPaire(p[12], p[13]); trierPaire(p[11], p[13]);
+        trierPaire(p[11], p[12]); trierPaire(p[15], p[16]); trierPaire(p[14], p[16]); trierPaire(p[14], p[15]);
+        trierPaire(p[18], p[19]); trierPaire(p[17], p[19]); trierPaire(p[17], p[18]); trierPaire(p[21], p[22]);
+        trierPaire(p[20], p[22]); trierPaire(p[20], p[21]); trierPaire(p[23], p[24]); trierPaire(p[2], p[5]);
+        trierPaire(p[3], p[6]); trierPaire(p[0], p[6]); trierPaire(p[0], p[3]); trierPaire(p[4], p[7]);
+        trierPaire(p[1], p[7]); trierPaire(p[1], p[4]); trierPaire(p[11], p[14]); trierPaire(p[8], p[14]);
+        trierPaire(p[8], p[11]); trierPaire(p[12], p[15]); trierPaire(p[9], p[15]); trierPaire(p[9], p[12]);
+        trierPaire(p[13], p[16]); trierPaire(p[10], p[16]); trierPaire(p[10], p[13]); trierPaire(p[20], p[23]);
+        trierPaire(p[17], p[23]); trierPaire(p[17], p[20]); trierPaire(p[21], p[24]); trierPaire(p[18], p[24]);
+        trierPaire(p[18], p[21]); trierPaire(p[19], p[22]); trierPaire(p[8], p[17]); trierPaire(p[9], p[18]);
+        trierPaire(p[0], p[18]); trierPaire(p[0], p[9]); trierPaire(p[10], p[19]); trierPaire(p[1], p[19]);
+        trierPaire(p[1], p[10]); trierPaire(p[11], p[20]); trierPaire(p[2], p[20]); trierPaire(p[2], p[11]);
+        trierPaire(p[12], p[21]); trierPaire(p[3], p[21]); trierPaire(p[3], p[12]); trierPaire(p[13], p[22]);
+        trierPaire(p[4], p[22]); trierPaire(p[4], p[13]); trierPaire(p[14], p[23]); trierPaire(p[5], p[23]);
+        trierPaire(p[5], p[14]); trierPaire(p[15], p[24]); trierPaire(p[6], p[24]); trierPaire(p[6], p[15]);
+        trierPaire(p[7], p[16]); trierPaire(p[7], p[19]); trierPaire(p[13], p[21]); trierPaire(p[15], p[23]);
+        trierPaire(p[7], p[13]); trierPaire(p[7], p[15]); trierPaire(p[1], p[9]); trierPaire(p[3], p[11]);
+        trierPaire(p[5], p[17]); trierPaire(p[11], p[17]); trierPaire(p[9], p[17]); trierPaire(p[4], p[10]);
+        trierPaire(p[6], p[12]); trierPaire(p[7], p[14]); trierPaire(p[4], p[6]); trierPaire(p[4], p[7]);
+        trierPaire(p[12], p[14]); trierPaire(p[10], p[14]); trierPaire(p[6], p[7]); trierPaire(p[10], p[12]);
+        trierPaire(p[6], p[10]); trierPaire(p[6], p[17]); trierPaire(p[12], p[17]); trierPaire(p[7], p[17]);
+        trierPaire(p[7], p[10]); trierPaire(p[12], p[18]); trierPaire(p[7], p[12]); trierPaire(p[10], p[18]);
+        trierPaire(p[12], p[20]); trierPaire(p[10], p[20]); trierPaire(p[10], p[12]);
+        sortie[x] = p[12];
+    }
+}
+
+// Histogramme d'une fenêtre glissante sur une image 8 bits : 256 cases fines suivies de
+// 16 cases grossières de 16 valeurs chacune
+const int NB_CASES_FENETRE = 256 + 16;
+
+// Histogramme de la fenêtre carrée de côté 2 rayon + 1 centrée sur un pixel, avec la
+// somme et la somme des carrés de ses pixels. Les deux niveaux permettent de lire le
+// nombre de pixels <= v, ou la valeur d'un rang donné, en au plus 16 + 16 additions,
+// quel que soit le rayon.
+template<typename Compteur>
+struct HistogrammeFenetre {
+    Compteur cases[NB_CASES_FENETRE];
+    uint32_t total;
+    uint64_t somme;
+    uint64_t sommeCarres;
+
+    // Nombre de pixels de la fenêtre inférieurs ou égaux à v
+    uint32_t rang(int v) const {
+        uint32_t nombre = 0;
+        int bloc = v >> 4;
+        for (int b = 0; b < bloc; ++b) {
+            nombre += cases[256 + b];
+        }
+        for (int k = bloc << 4; k <= v; ++k) {
+            nombre += cases[k];
+        }
+        return nombre;
+    }
+
+    // Plus petite valeur v telle que rang(v) > k, pour k < total (la médiane est
+    // valeurDeRang(total / 2))
+    int valeurDeRang(uint32_t k) const {
+        int bloc = 0;
+        while (k >= cases[256 + bloc]) {
+            k -= cases[256 + bloc];
+            ++bloc;
+        }
+        int v = bloc << 4;
+        while (k >= cases[v]) {
+            k -= cases[v];
+            ++v;
+        }
+        return v;
+    }
+};
+
+// Ajoute (Signe = 1) ou retire (Signe = -1) une ligne de l'image aux histogrammes de
+// colonnes
+template<int Signe, typename Compteur>
+inline void compterLigneColonnes(const uchar* ligne, int largeur, Compteur* colonnes, uint64_t* sommes,
+                                 uint64_t* sommesCarres) {
+    for (int x = 0; x < largeur; ++x) {
+        uint32_t v = ligne[x];
+        Compteur* colonne = colonnes + x * NB_CASES_FENETRE;
+        colonne[v] = static_cast<Compteur>(colonne[v] + Signe);
+        colonne[256 + (v >> 4)] = static_cast<Compteur>(colonne[256 + (v >> 4)] + Signe);
+        sommes[x] += static_cast<uint64_t>(static_cast<int64_t>(Signe) * v);
+        sommesCarres[x] += static_cast<uint64_t>(static_cast<int64_t>(Signe) * v * v);
+    }
+}
+
+// Parcourt les lignes [debut, fin[ d'une image 8 bits en niveaux de gris et appelle
+// requete(fenetre, y, x, valeur) pour chaque pixel, avec l'histogramme de sa fenêtre
+// (mode de bord par reflet, répliqué ou cyclique ; pas de valeur constante). On garde
+// l'histogramme de chaque colonne sur 2 rayon + 1 lignes (Huang, Perreault) : descendre
+// d'une ligne ajoute et retire un pixel par colonne, avancer d'un pixel ajoute une
+// colonne et en retire une, soit 272 additions vectorisées par pixel, quel que soit le
+// rayon. Compteur doit pouvoir compter (2 rayon + 1)^2 pixels. Les pixels arrivent
+// ligne par ligne, de gauche à droite : la requête peut garder la ligne de sortie en
+// cours d'un appel à l'autre.
+template<typename Compteur, typename Requete>
+void parcourirFenetres(const cv::Mat& image, int rayon, int debut, int fin, ModeBord mode, Requete& requete) {
+    int largeur = image.cols;
+    std::vector<Compteur> colonnes(largeur * NB_CASES_FENETRE, 0);
+    std::vector<uint64_t> sommes(largeur, 0), sommesCarres(largeur, 0);
+
+    // Colonne réelle de chaque colonne virtuelle, de -rayon - 1 à largeur + rayon
+    std::vector<int> indices(largeur + 2 * rayon + 2);
+    for (int x = -rayon - 1; x <= largeur + rayon; ++x) {
+        indices[x + rayon + 1] = indiceBord(x, largeur, mode);
+    }
+    const int* colonne = &indices[rayon + 1];
+
+    for (int dy = -rayon; dy <= rayon; ++dy) {
+        compterLigneColonnes<1>(image.ptr<uchar>(indiceBord(debut + dy, image.rows, mode)), largeur,
+                                &colonnes[0], &sommes[0], &sommesCarres[0]);
+    }
+
+    HistogrammeFenetre<Compteur> fenetre;
+    fenetre.total = static_cast<uint32_t>((2 * rayon + 1) * (2 * rayon + 1));
+    for (int y = debut; y < fin; ++y) {
+        if (y > debut) {
+            compterLigneColonnes<-1>(image.ptr<uchar>(indiceBord(y - rayon - 1, image.rows, mode)),
+                                     largeur, &colonnes[0], &sommes[0], &sommesCarres[0]);
+            compterLigneColonnes<1>(image.ptr<uchar>(indiceBord(y + rayon, image.rows, mode)),
+                                    largeur, &colonnes[0], &sommes[0], &sommesCarres[0]);
+        }
+
+        // Fenêtre du premier pixel de la ligne
+        std::fill(fenetre.cases, fenetre.cases + NB_CASES_FENETRE, Compteur(0));
+        fenetre.somme = 0;
+        fenetre.sommeCarres = 0;
+        for (int dx = -rayon; dx <= rayon; ++dx) {
+            const Compteur* ajout = &colonnes[colonne[dx] * NB_CASES_FENETRE];
+            for (int k = 0; k < NB_CASES_FENETRE; ++k) {
+                fenetre.cases[k] = static_cast<Compteur>(fenetre.cases[k] + ajout[k]);
+            }
+            fenetre.somme += sommes[colonne[dx]];
+            fenetre.sommeCarres += sommesCarres[colonne[dx]];
+        }
+
+        const uchar* ligne = image.ptr<uchar>(y);
+        for (int x = 0; x < largeur; ++x) {
+            if (x > 0) {
+                const Compteur* ajout = &colonnes[colonne[x + rayon] * NB_CASES_FENETRE];
+                const Compteur* retrait = &colonnes[colonne[x - rayon - 1] * NB_CASES_FENETRE];
+                for (int k = 0; k < NB_CASES_FENETRE; ++k) {
+                    fenetre.cases[k] = static_cast<Compteur>(fenetre.cases[k] + ajout[k] - retrait[k]);
+                }
+                fenetre.somme += sommes[colonne[x + rayon]] - sommes[colonne[x - rayon - 1]];
+                fenetre.sommeCarres += sommesCarres[colonne[x + rayon]] - sommesCarres[colonne[x - rayon - 1]];
+            }
+            requete(fenetre, y, x, ligne[x]);
+        }
+    }
+}
+
+// Coefficients du flou gaussien récursif de Young et van Vliet. Chaque passage calcule
+// w[n] = B x[n] + a1 w[n-1] + a2 w[n-2] + a3 w[n-3], d'abord dans un sens puis dans
+// l'autre. M relie les trois dernières valeurs du passage aller aux trois valeurs qui
+// amorcent le passage retour (Triggs et Sdika) : le filtre se comporte alors comme si
+// le signal était prolongé à l'infini par son dernier échantillon.
+struct CoefficientsRecursifs {
+    double B, a1, a2, a3;
+    double M[3][3];
+};
+
+// Passages aller et retour du filtre récursif le long de nbLignes lignes, sur les
+// valeurs [debut, fin) de chaque ligne, modifiées en place. Chaque étape de la récurrence
+// traite toute la tranche d'un coup : les colonnes avancent ensemble et la boucle
+// interne, sans dépendance d'une valeur à l'autre, est vectorisée. tampon reçoit
+// 5 * (fin - debut) valeurs.
+inline void gaussienRecursifLignes(double* const* lignes, int nbLignes, int debut, int fin,
+                                   const CoefficientsRecursifs& c, double* tampon) {
+    int n = fin - debut;
+    double* premiere = tampon;      // entrée avant l'image (bord répliqué)
+    double* derniere = tampon + n;  // entrée après l'image
+    double* suivantes[3] = {tampon + 2 * n, tampon + 3 * n, tampon + 4 * n};
+    std::memcpy(premiere, lignes[0] + debut, n * sizeof(double));
+    std::memcpy(derniere, lignes[nbLignes - 1] + debut, n * sizeof(double));
+
+    // Passage aller : avant l'image, le filtre a atteint son régime permanent
+    for (int y = 0; y < nbLignes; ++y) {
+        double* ligne = lignes[y] + debut;
+        const double* p1 = y >= 1 ? lignes[y - 1] + debut : premiere;
+        const double* p2 = y >= 2 ? lignes[y - 2] + debut : premiere;
+        const double* p3 = y >= 3 ? lignes[y - 3] + debut : premiere;
+        for (int x = 0; x < n; ++x) {
+            ligne[x] = c.B * ligne[x] + c.a1 * p1[x] + c.a2 * p2[x] + c.a3 * p3[x];
+        }
+    }
+
+    // Amorce du passage retour, à partir des trois dernières sorties du passage aller
+    const double* fins[3];
+    for (int j = 0; j < 3; ++j) {
+        fins[j] = nbLignes - 1 - j >= 0 ? lignes[nbLignes - 1 - j] + debut : premiere;
+    }
+    for (int i = 0; i < 3; ++i) {
+        double* s = suivantes[i];
+        for (int x = 0; x < n; ++x) {
+            double u = derniere[x];
+            s[x] = u + c.M[i][0] * (fins[0][x] - u) + c.M[i][1] * (fins[1][x] - u) + c.M[i][2] * (fins[2][x] - u);
+        }
+    }
+
+    // Passage retour
+    for (int y = nbLignes - 1; y >= 0; --y) {
+        double* ligne = lignes[y] + debut;
+        const double* s1 = y + 1 < nbLignes ? lignes[y + 1] + debut : suivantes[y + 1 - nbLignes];
+        const double* s2 = y + 2 < nbLignes ? lignes[y + 2] + debut : suivantes[y + 2 - nbLignes];
+        const double* s3 = y + 3 < nbLignes ? lignes[y + 3] + debut : suivantes[y + 3 - nbLignes];
+        for (int x = 0; x < n; ++x) {
+            ligne[x] = c.B * ligne[x] + c.a1 * s1[x] + c.a2 * s2[x] + c.a3 * s3[x];
+        }
+    }
+}
+
+// Union-find dans un tableau plat : parents[e] est le parent de l'étiquette e, une
+// racine est son propre parent. On rattache toujours la plus grande des deux racines à
+// la plus petite : parents[e] <= e, et la racine d'un ensemble est sa plus petite
+// étiquette, ce qui permet de renuméroter les ensembles en un seul passage croissant.
+inline int trouverRacine(int* parents, int e) {
+    int racine = e;
+    while (parents[racine] != racine) {
+        racine = parents[racine];
+    }
+    // Compression du chemin : tout le chemin pointe maintenant sur la racine
+    while (parents[e] != racine) {
+        int suivant = parents[e];
+        parents[e] = racine;
+        e = suivant;
+    }
+    return racine;
+}
+
+inline int unirEtiquettes(int* parents, int a, int b) {
+    int racineA = trouverRacine(parents, a);
+    int racineB = trouverRacine(parents, b);
+    if (racineA < racineB) {
+        parents[racineB] = racineA;
+        return racineA;
+    }
+    parents[racineA] = racineB;
+    return racineB;
+}
+
+// File de priorité sur 256 niveaux entiers : un seau par niveau, chacun vidé dans
+// l'ordre d'arrivée. Ajouter et retirer coûtent O(1) (plus, pour retirer, l'avance sur
+// les niveaux vides), contre O(log n) pour std::priority_queue, et à niveau égal les
+// éléments sortent dans leur ordre d'entrée. Chaque seau est un tampon circulaire : sa
+// mémoire suit la taille de la frontière, pas le nombre total d'éléments passés, et
+// reste dans le cache.
+class FileNiveaux {
+public:
+    static const int NB_NIVEAUX = 256;
+
+    FileNiveaux() : niveauMin(NB_NIVEAUX), taille(0) {}
+
+    bool vide() const { return taille == 0; }
+
+    // Plus petit niveau non vide (NB_NIVEAUX si la file est vide)
+    int niveauCourant() {
+        if (taille == 0) {
+            return NB_NIVEAUX;
+        }
+        while (seaux[niveauMin].tete == seaux[niveauMin].fin) {
+            ++niveauMin;
+        }
+        return niveauMin;
+    }
+
+    void ajouter(int niveau, uint32_t element) {
+        Seau& seau = seaux[niveau];
+        if (seau.fin - seau.tete == seau.elements.size()) {
+            seau.agrandir();
+        }
+        seau.donnees[seau.fin++ & seau.masque] = element;
+        if (niveau < niveauMin) {
+            niveauMin = niveau;
+        }
+        ++taille;
+    }
+
+    // Retire le premier élément arrivé au plus petit niveau ; la file ne doit pas être vide
+    uint32_t retirer() {
+        while (seaux[niveauMin].tete == seaux[niveauMin].fin) {
+            ++niveauMin;
+        }
+        Seau& seau = seaux[niveauMin];
+        --taille;
+        return seau.donnees[seau.tete++ & seau.masque];
+    }
+
+private:
+    // Tampon circulaire dont la taille est une puissance de 2 ; tete et fin avancent sans
+    // jamais revenir en arrière, seul leur reste modulo la taille indexe le tampon
+    struct Seau {
+        std::vector<uint32_t> elements;
+        uint32_t* donnees;
+        size_t masque;
+        size_t tete;
+        size_t fin;
+
+        Seau() : donnees(0), masque(0), tete(0), fin(0) {}
+
+        void agrandir() {
+            std::vector<uint32_t> plusGrand(std::max<size_t>(64, 2 * elements.size()));
+            for (size_t i = tete; i != fin; ++i) {
+                plusGrand[i - tete] = donnees[i & masque];
+            }
+            elements.swap(plusGrand);
+            donnees = elements.data();
+            masque = elements.size() - 1;
+            fin -= tete;
+            tete = 0;
+        }
+    };
+
+    Seau seaux[NB_NIVEAUX];
+    int niveauMin;
+    size_t taille;
+};
+
+#endif
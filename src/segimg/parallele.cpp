@@ -0,0 +1,19 @@
+#include "parallele.hpp"
+#include <algorithm>
+#include <thread>
+
+int& nombreThreadsParDefaut() {
+    static int nombreThreads = 0;
+    return nombreThreads;
+}
+
+void definirNombreThreads(int nombreThreads) {
+    nombreThreadsParDefaut() = nombreThreads;
+}
+
+int nombreThreadsEffectif(int nombreThreads) {
+    if (nombreThreads <= 0) {
+        nombreThreads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    return std::max(nombreThreads, 1);
+}
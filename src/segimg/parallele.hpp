@@ -0,0 +1,47 @@
+#ifndef SEGIMG_PARALLELE_HPP
+#define SEGIMG_PARALLELE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Nombre de threads utilisés par défaut par les calculs parallèles (0 = un par coeur)
+int& nombreThreadsParDefaut();
+
+void definirNombreThreads(int nombreThreads);
+
+// Convertit un nombre de threads demandé (0 ou négatif = un par coeur) en nombre réel
+int nombreThreadsEffectif(int nombreThreads);
+
+// Appelle tache(i) pour i de 0 à nbTaches - 1 sur au plus nombreThreads threads, le
+// thread appelant compris. Les indices sont distribués un par un par un compteur
+// atomique : des tâches de durées inégales (tuiles, bandes) s'équilibrent d'elles-mêmes.
+template<typename Tache>
+void executerEnParallele(int nbTaches, int nombreThreads, const Tache& tache) {
+    int nbThreads = std::min(nombreThreadsEffectif(nombreThreads), nbTaches);
+    if (nbThreads <= 1) {
+        for (int i = 0; i < nbTaches; ++i) {
+            tache(i);
+        }
+        return;
+    }
+
+    std::atomic<int> suivante(0);
+    auto travailler = [&]() {
+        for (int i = suivante.fetch_add(1); i < nbTaches; i = suivante.fetch_add(1)) {
+            tache(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < nbThreads; ++t) {
+        threads.emplace_back(travailler);
+    }
+    travailler();
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+}
+
+#endif
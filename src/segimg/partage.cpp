@@ -0,0 +1,276 @@
+#include "partage.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+// Une case garde l'étiquette au-dessus des 8 bits du niveau
+static const int NB_ETIQUETTES_MAX_PARTAGE = INT32_MAX >> 8;
+
+// Niveau d'un pixel qu'aucun bassin n'a encore atteint, au-dessus de tous les autres
+static const uint16_t NIVEAU_NON_ATTEINT = 256;
+
+static bool verifierPartage(const cv::Mat& relief, const cv::Mat& marqueurs) {
+    if (relief.type() != CV_8UC1) {
+        std::cerr << "ligneDePartageEaux : le relief doit etre en niveaux de gris 8 bits" << std::endl;
+        return false;
+    }
+    if (marqueurs.type() != CV_32SC1 || marqueurs.size() != relief.size()) {
+        std::cerr << "ligneDePartageEaux : les marqueurs doivent etre une image CV_32S de la taille du relief"
+                  << std::endl;
+        return false;
+    }
+    if (static_cast<uint64_t>(relief.rows + 2) * (relief.cols + 2) > UINT32_MAX) {
+        std::cerr << "ligneDePartageEaux : image trop grande" << std::endl;
+        return false;
+    }
+    double minimum, maximum;
+    cv::minMaxLoc(marqueurs, &minimum, &maximum);
+    if (maximum > NB_ETIQUETTES_MAX_PARTAGE) {
+        std::cerr << "ligneDePartageEaux : les etiquettes vont au plus a " << NB_ETIQUETTES_MAX_PARTAGE << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ligneDePartageEaux(const cv::Mat& relief, cv::Mat& marqueurs) {
+    if (!verifierPartage(relief, marqueurs)) {
+        return false;
+    }
+
+    // (étiquette << 8) | niveau, bordé d'un pixel à -1 : son étiquette n'est jamais
+    // nulle, il n'est donc jamais inondé
+    cv::Mat bordee(relief.rows + 2, relief.cols + 2, CV_32S);
+    executerEnParallele(bordee.rows, nombreThreadsParDefaut(), [&](int y) {
+        int32_t* sortie = bordee.ptr<int32_t>(y);
+        if (y == 0 || y == bordee.rows - 1) {
+            std::fill(sortie, sortie + bordee.cols, -1);
+            return;
+        }
+        const uchar* niveaux = relief.ptr<uchar>(y - 1);
+        const int* etiquettes = marqueurs.ptr<int>(y - 1);
+        sortie[0] = -1;
+        for (int x = 0; x < relief.cols; ++x) {
+            sortie[x + 1] = (std::max(etiquettes[x], 0) << 8) | niveaux[x];
+        }
+        sortie[relief.cols + 1] = -1;
+    });
+    int32_t* cases = bordee.ptr<int32_t>(0);
+    const int largeur = bordee.cols;
+    const int voisins[4] = {-1, 1, -largeur, largeur};
+
+    // Les marqueurs partent au niveau 0, dans l'ordre des lignes
+    FileNiveaux file;
+    for (int y = 1; y <= relief.rows; ++y) {
+        for (int x = 1; x <= relief.cols; ++x) {
+            uint32_t p = static_cast<uint32_t>(y) * largeur + x;
+            if ((cases[p] >> 8) != 0) {
+                file.ajouter(0, p);
+            }
+        }
+    }
+
+    // Un pixel prend l'étiquette du premier voisin inondé qui l'atteint, et n'entre qu'une
+    // fois dans la file
+    while (!file.vide()) {
+        const int niveau = file.niveauCourant();
+        const uint32_t p = file.retirer();
+        const int32_t etiquette = cases[p] & ~0xFF;
+        for (int k = 0; k < 4; ++k) {
+            const uint32_t q = p + voisins[k];
+            const int32_t valeur = cases[q];
+            if ((valeur >> 8) != 0) {
+                continue;
+            }
+            cases[q] = etiquette | valeur;
+            file.ajouter(std::max(niveau, static_cast<int>(valeur)), q);
+        }
+    }
+
+    executerEnParallele(relief.rows, nombreThreadsParDefaut(), [&](int y) {
+        const int32_t* ligne = bordee.ptr<int32_t>(y + 1) + 1;
+        int* sortie = marqueurs.ptr<int>(y);
+        for (int x = 0; x < relief.cols; ++x) {
+            sortie[x] = ligne[x] >> 8;
+        }
+    });
+    return true;
+}
+
+// Un pixel du bord d'une tuile atteint par-dessus une couture
+struct GermePartage {
+    uint32_t indice;
+    uint16_t niveau;
+    int32_t etiquette;
+};
+
+// Une tuile, dans des tableaux bordés d'un pixel. Le bord est au niveau 0 : rien ne
+// peut l'atteindre plus bas, il n'est donc jamais inondé.
+struct TuilePartage {
+    cv::Rect zone;
+    int largeur;
+    std::vector<uchar> relief;
+    std::vector<uint16_t> niveaux;
+    std::vector<int32_t> etiquettes;
+    std::vector<GermePartage> germes;
+
+    uint32_t indice(int x, int y) const {
+        return static_cast<uint32_t>(y - zone.y + 1) * largeur + (x - zone.x + 1);
+    }
+};
+
+// Inondation différentielle : un germe ou un voisin ne change que s'il est atteint
+// strictement plus bas qu'avant. Sans germe venu d'une couture, c'est l'inondation de
+// ligneDePartageEaux restreinte à la tuile.
+static void inonderTuile(TuilePartage& tuile) {
+    uint16_t* niveaux = tuile.niveaux.data();
+    int32_t* etiquettes = tuile.etiquettes.data();
+    const uchar* relief = tuile.relief.data();
+    const int voisins[4] = {-1, 1, -tuile.largeur, tuile.largeur};
+
+    FileNiveaux file;
+    for (size_t i = 0; i < tuile.germes.size(); ++i) {
+        const GermePartage& germe = tuile.germes[i];
+        if (germe.niveau < niveaux[germe.indice]) {
+            niveaux[germe.indice] = germe.niveau;
+            etiquettes[germe.indice] = germe.etiquette;
+            file.ajouter(germe.niveau, germe.indice);
+        }
+    }
+    tuile.germes.clear();
+
+    while (!file.vide()) {
+        const int niveau = file.niveauCourant();
+        const uint32_t p = file.retirer();
+        // Atteint plus bas depuis son entrée dans la file : il en est déjà ressorti
+        if (niveaux[p] != niveau) {
+            continue;
+        }
+        for (int k = 0; k < 4; ++k) {
+            const uint32_t q = p + voisins[k];
+            const int atteint = std::max(niveau, static_cast<int>(relief[q]));
+            if (atteint < niveaux[q]) {
+                niveaux[q] = static_cast<uint16_t>(atteint);
+                etiquettes[q] = etiquettes[p];
+                file.ajouter(atteint, q);
+            }
+        }
+    }
+}
+
+// Germes de la tuile depuis le pixel voisin (x, y) d'une autre tuile, pour son pixel
+// de bord (bx, by)
+static void proposerGerme(TuilePartage& tuile, int bx, int by, const TuilePartage& voisine, int x, int y) {
+    const uint32_t p = voisine.indice(x, y);
+    const uint32_t q = tuile.indice(bx, by);
+    const int atteint = std::max(static_cast<int>(voisine.niveaux[p]), static_cast<int>(tuile.relief[q]));
+    if (atteint < tuile.niveaux[q]) {
+        GermePartage germe = {q, static_cast<uint16_t>(atteint), voisine.etiquettes[p]};
+        tuile.germes.push_back(germe);
+    }
+}
+
+bool ligneDePartageEauxTuiles(const cv::Mat& relief, cv::Mat& marqueurs, int tailleTuile, int nombreThreads) {
+    if (!verifierPartage(relief, marqueurs)) {
+        return false;
+    }
+    if (tailleTuile < 1) {
+        std::cerr << "ligneDePartageEauxTuiles : la taille des tuiles doit etre positive" << std::endl;
+        return false;
+    }
+
+    const int nbColonnes = (relief.cols + tailleTuile - 1) / tailleTuile;
+    const int nbLignes = (relief.rows + tailleTuile - 1) / tailleTuile;
+    std::vector<TuilePartage> tuiles(nbColonnes * nbLignes);
+
+    // Chaque tuile recopie son relief et part de ses propres marqueurs, au niveau 0
+    executerEnParallele(static_cast<int>(tuiles.size()), nombreThreads, [&](int t) {
+        TuilePartage& tuile = tuiles[t];
+        int x0 = (t % nbColonnes) * tailleTuile;
+        int y0 = (t / nbColonnes) * tailleTuile;
+        tuile.zone = cv::Rect(x0, y0, std::min(tailleTuile, relief.cols - x0), std::min(tailleTuile, relief.rows - y0));
+        tuile.largeur = tuile.zone.width + 2;
+        size_t taille = static_cast<size_t>(tuile.largeur) * (tuile.zone.height + 2);
+        tuile.relief.assign(taille, 0);
+        tuile.niveaux.assign(taille, 0);
+        tuile.etiquettes.assign(taille, 0);
+        for (int y = tuile.zone.y; y < tuile.zone.br().y; ++y) {
+            const uchar* niveaux = relief.ptr<uchar>(y);
+            const int* etiquettes = marqueurs.ptr<int>(y);
+            for (int x = tuile.zone.x; x < tuile.zone.br().x; ++x) {
+                uint32_t i = tuile.indice(x, y);
+                tuile.relief[i] = niveaux[x];
+                tuile.niveaux[i] = NIVEAU_NON_ATTEINT;
+                if (etiquettes[x] > 0) {
+                    GermePartage germe = {i, 0, etiquettes[x]};
+                    tuile.germes.push_back(germe);
+                }
+            }
+        }
+    });
+
+    // Des tours d'inondation puis d'échange aux coutures, jusqu'à ce qu'aucun pixel de bord
+    // ne puisse plus descendre. Pendant l'échange, chaque tuile ne fait que lire ses
+    // voisines et écrire ses propres germes : le résultat ne dépend pas des threads.
+    for (bool germesEnAttente = true; germesEnAttente; ) {
+        executerEnParallele(static_cast<int>(tuiles.size()), nombreThreads, [&](int t) {
+            if (!tuiles[t].germes.empty()) {
+                inonderTuile(tuiles[t]);
+            }
+        });
+
+        executerEnParallele(static_cast<int>(tuiles.size()), nombreThreads, [&](int t) {
+            TuilePartage& tuile = tuiles[t];
+            const int colonne = t % nbColonnes;
+            const int ligne = t / nbColonnes;
+            const cv::Rect& zone = tuile.zone;
+            if (ligne > 0) {
+                const TuilePartage& haut = tuiles[t - nbColonnes];
+                for (int x = zone.x; x < zone.br().x; ++x) {
+                    proposerGerme(tuile, x, zone.y, haut, x, zone.y - 1);
+                }
+            }
+            if (ligne + 1 < nbLignes) {
+                const TuilePartage& bas = tuiles[t + nbColonnes];
+                for (int x = zone.x; x < zone.br().x; ++x) {
+                    proposerGerme(tuile, x, zone.br().y - 1, bas, x, zone.br().y);
+                }
+            }
+            if (colonne > 0) {
+                const TuilePartage& gauche = tuiles[t - 1];
+                for (int y = zone.y; y < zone.br().y; ++y) {
+                    proposerGerme(tuile, zone.x, y, gauche, zone.x - 1, y);
+                }
+            }
+            if (colonne + 1 < nbColonnes) {
+                const TuilePartage& droite = tuiles[t + 1];
+                for (int y = zone.y; y < zone.br().y; ++y) {
+                    proposerGerme(tuile, zone.br().x - 1, y, droite, zone.br().x, y);
+                }
+            }
+        });
+
+        germesEnAttente = false;
+        for (size_t t = 0; t < tuiles.size(); ++t) {
+            germesEnAttente = germesEnAttente || !tuiles[t].germes.empty();
+        }
+    }
+
+    executerEnParallele(static_cast<int>(tuiles.size()), nombreThreads, [&](int t) {
+        const TuilePartage& tuile = tuiles[t];
+        for (int y = tuile.zone.y; y < tuile.zone.br().y; ++y) {
+            int* sortie = marqueurs.ptr<int>(y);
+            for (int x = tuile.zone.x; x < tuile.zone.br().x; ++x) {
+                sortie[x] = tuile.etiquettes[tuile.indice(x, y)];
+            }
+        }
+    });
+    return true;
+}
+
+bool ligneDePartageEauxTuiles(const cv::Mat& relief, cv::Mat& marqueurs, int tailleTuile) {
+    return ligneDePartageEauxTuiles(relief, marqueurs, tailleTuile, nombreThreadsParDefaut());
+}
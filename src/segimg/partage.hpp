@@ -0,0 +1,35 @@
+#ifndef SEGIMG_PARTAGE_HPP
+#define SEGIMG_PARTAGE_HPP
+
+#include <opencv2/opencv.hpp>
+
+// Côté des tuiles de ligneDePartageEauxTuiles par défaut
+const int TAILLE_TUILE_PARTAGE = 256;
+
+// Ligne de partage des eaux par marqueurs, par inondation (Meyer) d'un relief 8 bits,
+// typiquement la norme du gradient de gradientSobel. marqueurs (CV_32S, taille du
+// relief) est lu puis réécrit sur place, comme avec cv::watershed : en entrée, chaque
+// bassin est marqué par une étiquette positive, 0 (ou négatif) partout ailleurs ; en
+// sortie, chaque pixel porte l'étiquette du bassin qui l'a inondé le premier, en
+// connexité 4. Il n'y a pas de ligne de crête à -1 : les bassins se touchent.
+//
+// L'inondation suit une file hiérarchique sur les 256 niveaux (FileNiveaux) : un pixel
+// entre dans la file au plus haut de son niveau et de celui du pixel qui l'atteint, et
+// les niveaux se vident dans l'ordre, chacun dans l'ordre d'arrivée. L'étiquette et le
+// niveau de chaque pixel partagent une case d'un tableau à plat bordé d'un pixel.
+// Renvoie false si le relief ou les marqueurs ne conviennent pas.
+bool ligneDePartageEaux(const cv::Mat& relief, cv::Mat& marqueurs);
+
+// Variante parallèle : l'image est découpée en tuiles de tailleTuile x tailleTuile
+// pixels, inondées chacune de son côté depuis ses propres marqueurs sur nombreThreads
+// threads (0 = un par coeur). Ensuite, tant qu'un pixel du bord d'une tuile peut être
+// atteint plus bas par-dessus la couture, il repart comme germe et sa tuile ne
+// ré-inonde que ce qui s'améliore. Le niveau auquel chaque pixel est inondé est
+// exactement celui de ligneDePartageEaux ; seuls les pixels qu'atteignent deux bassins
+// au même niveau (un plateau partagé) peuvent changer de côté selon les tuiles. Le
+// résultat ne dépend pas du nombre de threads.
+bool ligneDePartageEauxTuiles(const cv::Mat& relief, cv::Mat& marqueurs, int tailleTuile, int nombreThreads);
+
+bool ligneDePartageEauxTuiles(const cv::Mat& relief, cv::Mat& marqueurs, int tailleTuile = TAILLE_TUILE_PARTAGE);
+
+#endif
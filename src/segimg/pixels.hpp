@@ -0,0 +1,80 @@
+#ifndef SEGIMG_PIXELS_HPP
+#define SEGIMG_PIXELS_HPP
+
+// Types de pixels pris en charge par les noyaux : 8 bits, 16 bits non signés et
+// flottants 32 bits, avec 1, 3 ou 4 canaux entrelacés. Chaque noyau est un template
+// sur le type et le nombre de canaux ; on choisit l'instanciation une seule fois par
+// image, avec repartirSelonType, et la boucle chaude ne teste plus jamais le type.
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+template<typename T>
+struct TraitsPixel;
+
+template<>
+struct TraitsPixel<uchar> {
+    static const int profondeur = CV_8U;
+    // Dynamique utilisée par l'histogramme et l'égalisation : [0, valeurMax]
+    static double valeurMax() { return 255.0; }
+    static double borneHistogramme() { return 256.0; }
+};
+
+template<>
+struct TraitsPixel<ushort> {
+    static const int profondeur = CV_16U;
+    static double valeurMax() { return 65535.0; }
+    static double borneHistogramme() { return 65536.0; }
+};
+
+template<>
+struct TraitsPixel<float> {
+    static const int profondeur = CV_32F;
+    // Une image flottante est supposée dans [0, 1], comme pour cv::imshow
+    static double valeurMax() { return 1.0; }
+    static double borneHistogramme() { return 1.0; }
+};
+
+// valeurMax() pour une profondeur connue seulement à l'exécution
+inline double valeurMaxProfondeur(int profondeur) {
+    switch (profondeur) {
+        case CV_16U: return TraitsPixel<ushort>::valeurMax();
+        case CV_32F: return TraitsPixel<float>::valeurMax();
+        default:     return TraitsPixel<uchar>::valeurMax();
+    }
+}
+
+// Appelle foncteur.template appliquer<T, Canaux>() selon le type OpenCV de l'image.
+// Renvoie false si le type n'est pas pris en charge.
+template<typename Foncteur>
+bool repartirSelonType(int type, Foncteur& foncteur) {
+    switch (type) {
+        case CV_8UC1:  foncteur.template appliquer<uchar, 1>(); return true;
+        case CV_8UC3:  foncteur.template appliquer<uchar, 3>(); return true;
+        case CV_8UC4:  foncteur.template appliquer<uchar, 4>(); return true;
+        case CV_16UC1: foncteur.template appliquer<ushort, 1>(); return true;
+        case CV_16UC3: foncteur.template appliquer<ushort, 3>(); return true;
+        case CV_16UC4: foncteur.template appliquer<ushort, 4>(); return true;
+        case CV_32FC1: foncteur.template appliquer<float, 1>(); return true;
+        case CV_32FC3: foncteur.template appliquer<float, 3>(); return true;
+        case CV_32FC4: foncteur.template appliquer<float, 4>(); return true;
+        default:       return false;
+    }
+}
+
+// Nombre de lignes et de valeurs (pixels x canaux) par ligne à parcourir : des images
+// continues en mémoire se parcourent comme une seule grande ligne
+inline void dimensionsParcours(const cv::Mat& image, const cv::Mat& autre, int& nbLignes, int& nbValeurs) {
+    nbLignes = image.rows;
+    nbValeurs = image.cols * image.channels();
+    if (image.isContinuous() && autre.isContinuous()) {
+        nbValeurs *= nbLignes;
+        nbLignes = 1;
+    }
+}
+
+inline void dimensionsParcours(const cv::Mat& image, int& nbLignes, int& nbValeurs) {
+    dimensionsParcours(image, image, nbLignes, nbValeurs);
+}
+
+#endif
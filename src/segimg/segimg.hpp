@@ -0,0 +1,20 @@
+#ifndef SEGIMG_SEGIMG_HPP
+#define SEGIMG_SEGIMG_HPP
+
+// En-tête principal de la bibliothèque libsegimg
+
+#include "affichage.hpp"
+#include "contraste.hpp"
+#include "croissance.hpp"
+#include "etiquetage.hpp"
+#include "filtre.hpp"
+#include "histogramme.hpp"
+#include "integrale.hpp"
+#include "local.hpp"
+#include "noyaux.hpp"
+#include "parallele.hpp"
+#include "partage.hpp"
+#include "pixels.hpp"
+#include "seuillage.hpp"
+
+#endif
@@ -0,0 +1,351 @@
+#include "seuillage.hpp"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include "filtre.hpp"
+#include "histogramme.hpp"
+#include "integrale.hpp"
+#include "noyaux.hpp"
+#include "parallele.hpp"
+
+// Nombre de niveaux de gris d'une image 8 bits
+static const int NB_NIVEAUX = 256;
+
+// Au-delà de cette fenêtre, la moyenne gaussienne passe par le filtre récursif : sigma
+// y dépasse 3, où il reste à moins de 1 % d'une vraie gaussienne
+static const int TAILLE_MAX_GAUSSIEN_DIRECT = 17;
+
+// Hauteur minimale d'une bande du seuillage adaptatif, pour que la marge intégrée en
+// plus reste petite devant elle
+static const int HAUTEUR_MIN_BANDE_SEUILLAGE = 64;
+
+// Sommes cumulées des pixels et des niveaux : la classe des niveaux [a, b[ compte
+// pixels[b] - pixels[a] pixels, de somme niveaux[b] - niveaux[a]
+struct SommesOtsu {
+    double pixels[NB_NIVEAUX + 1];
+    double niveaux[NB_NIVEAUX + 1];
+
+    // Contribution de la classe [a, b[ à la variance inter-classes, à une constante près
+    double contribution(int a, int b) const {
+        double nombre = pixels[b] - pixels[a];
+        if (nombre <= 0.0) {
+            return 0.0;
+        }
+        double somme = niveaux[b] - niveaux[a];
+        return somme * somme / nombre;
+    }
+};
+
+static bool verifierNbClassesOtsu(int nbClasses) {
+    if (nbClasses < 2 || nbClasses > NB_CLASSES_OTSU_MAX) {
+        std::cerr << "Le seuillage d'Otsu prend de 2 à " << NB_CLASSES_OTSU_MAX << " classes." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Programmation dynamique sur les coupures, à partir des sommes cumulées
+static void seuilsOtsuSommes(const SommesOtsu& sommes, int nbClasses, std::vector<int>& seuils) {
+    // meilleur[k][j] : meilleur critère pour les niveaux [0, j[ en k + 1 classes non
+    // vides en niveaux ; coupure[k][j] : début de la dernière de ces classes
+    std::vector<std::vector<double> > meilleur(nbClasses, std::vector<double>(NB_NIVEAUX + 1, 0.0));
+    std::vector<std::vector<int> > coupure(nbClasses, std::vector<int>(NB_NIVEAUX + 1, 0));
+    for (int j = 1; j <= NB_NIVEAUX; ++j) {
+        meilleur[0][j] = sommes.contribution(0, j);
+    }
+    for (int k = 1; k < nbClasses; ++k) {
+        // Seule la fin de l'histogramme compte pour la dernière classe
+        int jDebut = k + 1 < nbClasses ? k + 1 : NB_NIVEAUX;
+        for (int j = jDebut; j <= NB_NIVEAUX; ++j) {
+            double critere = -1.0;
+            int meilleureCoupure = k;
+            for (int i = k; i < j; ++i) {
+                double valeur = meilleur[k - 1][i] + sommes.contribution(i, j);
+                // Strictement : à égalité, la coupure la plus basse
+                if (valeur > critere) {
+                    critere = valeur;
+                    meilleureCoupure = i;
+                }
+            }
+            meilleur[k][j] = critere;
+            coupure[k][j] = meilleureCoupure;
+        }
+    }
+
+    // On remonte les coupures depuis la fin de l'histogramme
+    seuils.assign(nbClasses - 1, 0);
+    int fin = NB_NIVEAUX;
+    for (int k = nbClasses - 1; k >= 1; --k) {
+        fin = coupure[k][fin];
+        seuils[k - 1] = fin - 1;
+    }
+}
+
+bool seuilsOtsu(const HistogrammeEntier<uint64_t>& hist, int nbClasses, std::vector<int>& seuils) {
+    if (!verifierNbClassesOtsu(nbClasses)) {
+        return false;
+    }
+    if (hist.nbCases() != NB_NIVEAUX) {
+        std::cerr << "Le seuillage d'Otsu attend un histogramme de 256 cases." << std::endl;
+        return false;
+    }
+
+    // Les cumuls sont entiers, donc exacts ; le passage en double l'est aussi tant
+    // qu'ils restent sous 2^53
+    SommesOtsu sommes;
+    uint64_t pixels = 0, niveaux = 0;
+    sommes.pixels[0] = 0.0;
+    sommes.niveaux[0] = 0.0;
+    for (int v = 0; v < NB_NIVEAUX; ++v) {
+        pixels += hist[v];
+        niveaux += hist[v] * static_cast<uint64_t>(v);
+        sommes.pixels[v + 1] = static_cast<double>(pixels);
+        sommes.niveaux[v + 1] = static_cast<double>(niveaux);
+    }
+    seuilsOtsuSommes(sommes, nbClasses, seuils);
+    return true;
+}
+
+bool seuilsOtsu(const cv::Mat& hist, int nbClasses, std::vector<int>& seuils) {
+    if (!verifierNbClassesOtsu(nbClasses)) {
+        return false;
+    }
+    if (hist.type() != CV_32FC1 || hist.rows != 1 || hist.cols != NB_NIVEAUX) {
+        std::cerr << "Le seuillage d'Otsu attend un histogramme 1x256 en CV_32F." << std::endl;
+        return false;
+    }
+
+    // On cumule en double, sans repasser par des float : des comptes entiers restent
+    // exacts
+    SommesOtsu sommes;
+    sommes.pixels[0] = 0.0;
+    sommes.niveaux[0] = 0.0;
+    for (int v = 0; v < NB_NIVEAUX; ++v) {
+        double nombre = hist.at<float>(0, v);
+        sommes.pixels[v + 1] = sommes.pixels[v] + nombre;
+        sommes.niveaux[v + 1] = sommes.niveaux[v] + nombre * v;
+    }
+    seuilsOtsuSommes(sommes, nbClasses, seuils);
+    return true;
+}
+
+int seuilOtsu(const cv::Mat& hist) {
+    std::vector<int> seuils;
+    return seuilsOtsu(hist, 2, seuils) ? seuils[0] : -1;
+}
+
+void appliquerSeuils(const cv::Mat& image, cv::Mat& resultat, const std::vector<int>& seuils,
+                     const std::vector<uchar>& valeurs) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "Le seuillage attend une image en niveaux de gris 8 bits." << std::endl;
+        return;
+    }
+    if (valeurs.size() != seuils.size() + 1) {
+        std::cerr << "Il faut une valeur de plus que de seuils." << std::endl;
+        return;
+    }
+
+    // La table : on passe à la classe suivante après chaque seuil
+    uchar table[NB_NIVEAUX];
+    size_t classe = 0;
+    for (int v = 0; v < NB_NIVEAUX; ++v) {
+        while (classe < seuils.size() && v > seuils[classe]) {
+            ++classe;
+        }
+        table[v] = valeurs[classe];
+    }
+
+    resultat.create(image.size(), CV_8UC1);
+    appliquerTableCanaux<uchar, 1>(image, resultat, table, NB_NIVEAUX, IndexeurDecalage(0));
+}
+
+void appliquerSeuils(const cv::Mat& image, cv::Mat& resultat, const std::vector<int>& seuils) {
+    int nbIntervalles = std::max(static_cast<int>(seuils.size()), 1);
+    std::vector<uchar> valeurs(seuils.size() + 1);
+    for (size_t k = 0; k < valeurs.size(); ++k) {
+        valeurs[k] = static_cast<uchar>((255 * static_cast<int>(k) + nbIntervalles / 2) / nbIntervalles);
+    }
+    appliquerSeuils(image, resultat, seuils, valeurs);
+}
+
+bool segmenterOtsu(const cv::Mat& image, cv::Mat& resultat, int nbClasses, std::vector<int>& seuils) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "Le seuillage d'Otsu attend une image en niveaux de gris 8 bits." << std::endl;
+        return false;
+    }
+
+    HistogrammeEntier<uint64_t> hist;
+    calculerHistogramme(image, hist);
+    if (!seuilsOtsu(hist, nbClasses, seuils)) {
+        return false;
+    }
+    appliquerSeuils(image, resultat, seuils);
+    return true;
+}
+
+bool segmenterOtsu(const cv::Mat& image, cv::Mat& resultat, int nbClasses) {
+    std::vector<int> seuils;
+    return segmenterOtsu(image, resultat, nbClasses, seuils);
+}
+
+// Comparaison à la moyenne, exactement comme cv::adaptiveThreshold : la moyenne est
+// d'abord arrondie en 8 bits, puis pixel - moyenne est comparé à -ceil(C) (ou, en
+// inversé, à -floor(C))
+struct SeuilMoyenne {
+    int margeBinaire;
+    int margeInverse;
+    bool inverser;
+
+    void comparer(const uchar* source, const uchar* moyennes, uchar* destination, int largeur) const {
+        for (int x = 0; x < largeur; ++x) {
+            int ecart = source[x] - moyennes[x];
+            bool blanc = inverser ? ecart <= margeInverse : ecart > margeBinaire;
+            destination[x] = blanc ? 255 : 0;
+        }
+    }
+};
+
+// Les sommes de la fenêtre donnent sa moyenne (arrondie, pour la méthode de la moyenne)
+// ou sa moyenne et son écart-type (Niblack, Sauvola)
+struct SeuilFenetre {
+    MethodeSeuillage methode;
+    SeuilMoyenne moyenne;
+    double inverseNombre;
+    double k;
+    double inverseR;
+    bool inverser;
+
+    template<typename Somme>
+    void operator()(const uchar* source, const Somme* sommes, const Somme* sommesCarres, uchar* destination,
+                    uchar* tampon, int largeur) const {
+        if (methode == SEUIL_MOYENNE) {
+            // Une fenêtre impaire ne tombe jamais à mi-chemin : + 0.5 arrondit exactement
+            for (int x = 0; x < largeur; ++x) {
+                tampon[x] = static_cast<uchar>(static_cast<int>(static_cast<double>(sommes[x]) * inverseNombre + 0.5));
+            }
+            moyenne.comparer(source, tampon, destination, largeur);
+            return;
+        }
+        for (int x = 0; x < largeur; ++x) {
+            double m = static_cast<double>(sommes[x]) * inverseNombre;
+            double variance = std::max(static_cast<double>(sommesCarres[x]) * inverseNombre - m * m, 0.0);
+            double s = std::sqrt(variance);
+            double seuil = methode == SEUIL_NIBLACK ? m + k * s : m * (1.0 + k * (s * inverseR - 1.0));
+            bool blanc = (source[x] > seuil) != inverser;
+            destination[x] = blanc ? 255 : 0;
+        }
+    }
+};
+
+// Seuille les lignes [debut, fin[ : la bande, prolongée de taille / 2 lignes et
+// colonnes de chaque côté (bord répliqué), est intégrée, puis chaque ligne lit les
+// sommes de ses fenêtres d'un coup
+template<typename Somme>
+static void seuillerBande(const cv::Mat& image, cv::Mat& sortie, int debut, int fin, int taille,
+                         const SeuilFenetre& seuil) {
+    int rayon = taille / 2;
+    cv::Mat bande(fin - debut + 2 * rayon, image.cols + 2 * rayon, CV_8UC1);
+    for (int y = 0; y < bande.rows; ++y) {
+        prolongerLigne(image, debut - rayon + y, rayon, BORD_REPLIQUE, 0, bande.ptr<uchar>(y));
+    }
+    ImageIntegrale<Somme> integrale;
+    integrale.calculer(bande, seuil.methode != SEUIL_MOYENNE);
+
+    std::vector<Somme> sommes(image.cols), sommesCarres(image.cols);
+    std::vector<uchar> tampon(image.cols);
+    for (int y = debut; y < fin; ++y) {
+        integrale.sommesLigne(y - debut, taille, taille, image.cols, &sommes[0]);
+        if (seuil.methode != SEUIL_MOYENNE) {
+            integrale.sommesCarresLigne(y - debut, taille, taille, image.cols, &sommesCarres[0]);
+        }
+        seuil(image.ptr<uchar>(y), &sommes[0], &sommesCarres[0], sortie.ptr<uchar>(y), &tampon[0], image.cols);
+    }
+}
+
+// Noyau gaussien de cv::getGaussianKernel pour une fenêtre de côté taille, avec
+// l'écart type qu'en déduit cv::adaptiveThreshold ; jusqu'à 7, OpenCV prend des
+// coefficients tabulés
+static cv::Mat noyauGaussienSeuillage(int taille) {
+    static const double tabulees[4][7] = {
+        {1.0},
+        {0.25, 0.5, 0.25},
+        {0.0625, 0.25, 0.375, 0.25, 0.0625},
+        {0.03125, 0.109375, 0.21875, 0.28125, 0.21875, 0.109375, 0.03125}};
+    double sigma = 0.3 * ((taille - 1) * 0.5 - 1.0) + 0.8;
+    std::vector<double> poids(taille);
+    double total = 0.0;
+    for (int i = 0; i < taille; ++i) {
+        double d = i - (taille - 1) * 0.5;
+        poids[i] = taille <= 7 ? tabulees[taille / 2][i] : std::exp(-d * d / (2.0 * sigma * sigma));
+        total += poids[i];
+    }
+    cv::Mat noyau(taille, taille, CV_64F);
+    for (int y = 0; y < taille; ++y) {
+        for (int x = 0; x < taille; ++x) {
+            noyau.at<double>(y, x) = poids[y] * poids[x] / (total * total);
+        }
+    }
+    return noyau;
+}
+
+void seuillageAdaptatif(const cv::Mat& image, cv::Mat& resultat, const OptionsSeuillage& options, int nombreThreads) {
+    if (image.type() != CV_8UC1) {
+        std::cerr << "Le seuillage adaptatif attend une image en niveaux de gris 8 bits." << std::endl;
+        return;
+    }
+    if (options.taille < 3 || options.taille % 2 == 0) {
+        std::cerr << "La fenêtre du seuillage adaptatif doit avoir un côté impair d'au moins 3." << std::endl;
+        return;
+    }
+    if (options.methode == SEUIL_SAUVOLA && !(options.R > 0.0)) {
+        std::cerr << "La dynamique R de Sauvola doit être positive." << std::endl;
+        return;
+    }
+
+    // Nouvelle image : image et resultat peuvent être la même matrice
+    cv::Mat sortie(image.size(), CV_8UC1);
+    if (image.empty()) {
+        resultat = sortie;
+        return;
+    }
+    SeuilMoyenne moyenne = {-static_cast<int>(std::ceil(options.C)), -static_cast<int>(std::floor(options.C)),
+                            options.inverser};
+    int nbBandes = std::max(1, std::min(4 * nombreThreadsEffectif(nombreThreads),
+                                        image.rows / std::max(options.taille, HAUTEUR_MIN_BANDE_SEUILLAGE)));
+
+    if (options.methode == SEUIL_GAUSSIEN) {
+        cv::Mat moyennes;
+        if (options.taille <= TAILLE_MAX_GAUSSIEN_DIRECT) {
+            moyennes = appliquerFiltre(image, noyauGaussienSeuillage(options.taille), BORD_REPLIQUE);
+        } else {
+            moyennes = flouGaussienRecursif(image, 0.3 * ((options.taille - 1) * 0.5 - 1.0) + 0.8, nombreThreads);
+        }
+        executerEnParallele(nbBandes, nombreThreads, [&](int b) {
+            for (int y = image.rows * b / nbBandes; y < image.rows * (b + 1) / nbBandes; ++y) {
+                moyenne.comparer(image.ptr<uchar>(y), moyennes.ptr<uchar>(y), sortie.ptr<uchar>(y), image.cols);
+            }
+        });
+        resultat = sortie;
+        return;
+    }
+
+    SeuilFenetre seuil = {options.methode, moyenne, 1.0 / (static_cast<double>(options.taille) * options.taille),
+                          options.k, 1.0 / options.R, options.inverser};
+    // Les sommes de carrés d'une fenêtre de plus de 257 x 257 ne tiennent plus en 32 bits
+    bool sommes32Bits = static_cast<uint64_t>(options.taille) * options.taille * 255 * 255 <=
+                        std::numeric_limits<uint32_t>::max();
+    executerEnParallele(nbBandes, nombreThreads, [&](int b) {
+        int debut = image.rows * b / nbBandes;
+        int fin = image.rows * (b + 1) / nbBandes;
+        if (sommes32Bits) {
+            seuillerBande<uint32_t>(image, sortie, debut, fin, options.taille, seuil);
+        } else {
+            seuillerBande<uint64_t>(image, sortie, debut, fin, options.taille, seuil);
+        }
+    });
+    resultat = sortie;
+}
+
+void seuillageAdaptatif(const cv::Mat& image, cv::Mat& resultat, const OptionsSeuillage& options) {
+    seuillageAdaptatif(image, resultat, options, nombreThreadsParDefaut());
+}
@@ -0,0 +1,91 @@
+#ifndef SEGIMG_SEUILLAGE_HPP
+#define SEGIMG_SEUILLAGE_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "histogramme.hpp"
+
+// Seuillage : première étape de la segmentation, chaque pixel reçoit la classe de
+// l'intervalle de niveaux de gris où il tombe. La classe k regroupe les niveaux
+// ]seuils[k - 1], seuils[k]] : comme avec cv::threshold, un pixel strictement au-dessus
+// d'un seuil passe dans la classe suivante.
+
+// Nombre maximal de classes de seuilsOtsu
+const int NB_CLASSES_OTSU_MAX = 4;
+
+// Seuils d'Otsu multi-niveaux d'un histogramme entier de 256 cases
+// (calculerHistogramme) : les nbClasses - 1 seuils croissants qui maximisent la
+// variance inter-classes, soit la somme des (somme des niveaux)^2 / (nombre de pixels)
+// des classes. Les sommes de chaque intervalle se lisent dans deux cumuls entiers
+// exacts, des pixels et des niveaux ; la programmation dynamique sur les coupures coûte
+// O(nbClasses x 256^2), quelle que soit la taille de l'image. À égalité, on garde les
+// seuils les plus bas, comme cv::threshold. Renvoie false si nbClasses n'est pas entre
+// 2 et NB_CLASSES_OTSU_MAX ou si l'histogramme n'a pas 256 cases.
+bool seuilsOtsu(const HistogrammeEntier<uint64_t>& hist, int nbClasses, std::vector<int>& seuils);
+
+// Même calcul sur un histogramme 1x256 en CV_32F (monCalcHist), cumulé en double : le
+// résultat est exact tant que chaque case l'est en float
+bool seuilsOtsu(const cv::Mat& hist, int nbClasses, std::vector<int>& seuils);
+
+// Seuil d'Otsu à deux classes, celui de cv::threshold avec THRESH_OTSU (-1 si
+// l'histogramme n'a pas 256 cases)
+int seuilOtsu(const cv::Mat& hist);
+
+// Remplace chaque pixel d'une image 8 bits en niveaux de gris par la valeur de sa
+// classe (valeurs a seuils.size() + 1 entrées) : la table des 256 niveaux est construite
+// une fois, puis l'image est parcourue en une seule passe. image et resultat peuvent
+// être la même matrice.
+void appliquerSeuils(const cv::Mat& image, cv::Mat& resultat, const std::vector<int>& seuils,
+                     const std::vector<uchar>& valeurs);
+
+// Valeurs des classes réparties de 0 à 255 (0 et 255 pour deux classes)
+void appliquerSeuils(const cv::Mat& image, cv::Mat& resultat, const std::vector<int>& seuils);
+
+// Segmentation d'Otsu d'une image 8 bits en niveaux de gris en nbClasses : une passe
+// pour l'histogramme entier (calculerHistogramme), une passe pour la table. Les seuils
+// trouvés sont rendus dans seuils.
+bool segmenterOtsu(const cv::Mat& image, cv::Mat& resultat, int nbClasses, std::vector<int>& seuils);
+
+bool segmenterOtsu(const cv::Mat& image, cv::Mat& resultat, int nbClasses = 2);
+
+// Seuillage adaptatif : chaque pixel est comparé à un seuil tiré de la fenêtre
+// taille x taille centrée sur lui (bords répliqués), là où un seuil global échoue sur un
+// éclairage inégal (Cells.png, Fingerprint.png). Un pixel au-dessus de son seuil passe
+// à 255, les autres à 0 (l'inverse si inverser).
+enum MethodeSeuillage {
+    SEUIL_MOYENNE,   // moyenne de la fenêtre - C, comme ADAPTIVE_THRESH_MEAN_C
+    SEUIL_GAUSSIEN,  // moyenne pondérée par une gaussienne - C, comme ADAPTIVE_THRESH_GAUSSIAN_C
+    SEUIL_NIBLACK,   // moyenne + k x écart-type
+    SEUIL_SAUVOLA    // moyenne x (1 + k x (écart-type / R - 1)), pour les documents
+};
+
+struct OptionsSeuillage {
+    MethodeSeuillage methode;
+    int taille;      // côté impair de la fenêtre, au moins 3
+    double C;        // moyenne et gaussien : constante retirée à la moyenne
+    double k;        // Niblack et Sauvola : poids de l'écart-type
+    double R;        // Sauvola : dynamique de l'écart-type
+    bool inverser;   // comme THRESH_BINARY_INV : 255 pour les pixels sous le seuil
+
+    // Les valeurs habituelles : k = -0.2 pour Niblack, 0.5 et R = 128 pour Sauvola
+    explicit OptionsSeuillage(MethodeSeuillage methode = SEUIL_SAUVOLA, int taille = 31)
+        : methode(methode), taille(taille), C(5.0), k(methode == SEUIL_NIBLACK ? -0.2 : 0.5), R(128.0),
+          inverser(false) {}
+};
+
+// Seuillage adaptatif d'une image 8 bits en niveaux de gris. La moyenne, Niblack et
+// Sauvola lisent la somme et la somme des carrés de chaque fenêtre dans des images
+// intégrales (ImageIntegrale) : le coût par pixel ne dépend pas de la taille de la
+// fenêtre. L'image est découpée en bandes de lignes, chacune intégrée avec une marge de
+// taille / 2 lignes au-dessus et au-dessous, et réparties sur nombreThreads threads
+// (0 = un par coeur). La moyenne gaussienne vient de appliquerFiltre, puis de
+// flouGaussienRecursif au-delà d'une fenêtre 17 x 17 ; comme pour cv::adaptiveThreshold,
+// son écart type est 0.3 x ((taille - 1) / 2 - 1) + 0.8. La méthode de la moyenne
+// donne exactement le résultat de cv::adaptiveThreshold, C compris ; la gaussienne n'en
+// diffère que par l'arrondi de la moyenne pondérée, et par l'approximation du filtre
+// récursif au-delà de 17 x 17.
+void seuillageAdaptatif(const cv::Mat& image, cv::Mat& resultat, const OptionsSeuillage& options, int nombreThreads);
+
+void seuillageAdaptatif(const cv::Mat& image, cv::Mat& resultat, const OptionsSeuillage& options = OptionsSeuillage());
+
+#endif
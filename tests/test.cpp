@@ -0,0 +1,1216 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+#include "fonctions.hpp"
+
+// Vérification sans fenêtre : chaque fonction de fonctions.hpp est comparée à son
+// équivalent OpenCV, pixel par pixel, avec une tolérance explicite. On teste les
+// images du dossier Images/ et des images aléatoires (tailles quelconques, sous-images
+// non continues). Le programme renvoie 1 au premier écart hors tolérance, avec un
+// résumé de la différence.
+
+int nbVerifications = 0;
+int nbEchecs = 0;
+
+// Compare deux images de même taille (converties en double) et affiche un résumé en
+// cas d'écart : écart maximal, nombre de pixels hors tolérance, premier pixel fautif.
+bool verifierImages(const std::string& nom, const cv::Mat& obtenu, const cv::Mat& attendu, double tolerance) {
+    ++nbVerifications;
+
+    if (obtenu.size() != attendu.size() || obtenu.channels() != attendu.channels()) {
+        std::cerr << "ECHEC " << nom << " : tailles differentes (" << obtenu.cols << "x" << obtenu.rows << " contre "
+                  << attendu.cols << "x" << attendu.rows << ")" << std::endl;
+        ++nbEchecs;
+        return false;
+    }
+
+    cv::Mat a, b;
+    obtenu.convertTo(a, CV_64F);
+    attendu.convertTo(b, CV_64F);
+
+    double ecartMax = 0.0;
+    int nbHorsTolerance = 0;
+    int premierX = -1;
+    int premierY = -1;
+    for (int y = 0; y < a.rows; ++y) {
+        const double* ligneA = a.ptr<double>(y);
+        const double* ligneB = b.ptr<double>(y);
+        for (int x = 0; x < a.cols * a.channels(); ++x) {
+            double ecart = std::abs(ligneA[x] - ligneB[x]);
+            ecartMax = std::max(ecartMax, ecart);
+            if (ecart > tolerance) {
+                if (nbHorsTolerance == 0) {
+                    premierX = x / a.channels();
+                    premierY = y;
+                }
+                ++nbHorsTolerance;
+            }
+        }
+    }
+
+    if (nbHorsTolerance > 0) {
+        std::cerr << "ECHEC " << nom << " : " << nbHorsTolerance << " valeur(s) sur " << a.total() * a.channels()
+                  << " hors tolerance " << tolerance << ", ecart max " << ecartMax << ", premier ecart en ("
+                  << premierX << ", " << premierY << ") : " << a.at<double>(premierY, premierX * a.channels())
+                  << " au lieu de " << b.at<double>(premierY, premierX * b.channels()) << std::endl;
+        ++nbEchecs;
+        return false;
+    }
+    return true;
+}
+
+void histogrammeOpenCV(const cv::Mat& image, cv::Mat& hist) {
+    int channels[] = {0};
+    int histSize[] = {256};
+    float range[] = {0, 256};
+    const float* ranges[] = {range};
+    cv::calcHist(&image, 1, channels, cv::Mat(), hist, 1, histSize, ranges, true, false);
+    // calcHist rend une colonne 256x1, nos histogrammes sont des lignes 1x256
+    hist = hist.reshape(1, 1);
+}
+
+void testerHistogramme(const std::string& nom, const cv::Mat& image) {
+    cv::Mat attendu, obtenu, naif, parallele;
+    histogrammeOpenCV(image, attendu);
+
+    monCalcHist(image, obtenu);
+    verifierImages(nom + " monCalcHist", obtenu, attendu, 0.0);
+
+    monCalcHistNaif(image, naif);
+    verifierImages(nom + " monCalcHistNaif", naif, attendu, 0.0);
+
+    for (int nbThreads = 2; nbThreads <= 5; nbThreads += 3) {
+        monCalcHistParallele(image, parallele, nbThreads);
+        verifierImages(nom + " monCalcHistParallele " + std::to_string(nbThreads), parallele, attendu, 0.0);
+    }
+
+    cv::Mat cumule, cumuleAttendu;
+    imgToHistoCumul(image, cumule);
+    calculerHistogrammeCumule(attendu, cumuleAttendu);
+    verifierImages(nom + " imgToHistoCumul", cumule, cumuleAttendu, 0.0);
+
+    // Les histogrammes entiers, et leur cumul
+    HistogrammeEntier<uint32_t> hist32, cumul32;
+    HistogrammeEntier<uint64_t> hist64;
+    calculerHistogramme(image, hist32);
+    calculerHistogramme(image, hist64);
+    verifierImages(nom + " calculerHistogramme uint32", hist32.enFlottant(), attendu, 0.0);
+    verifierImages(nom + " calculerHistogramme uint64", hist64.enFlottant(), attendu, 0.0);
+    hist32.cumuler(cumul32);
+    verifierImages(nom + " cumuler", cumul32.enFlottant(), cumuleAttendu, 0.0);
+}
+
+// Au-delà de 2^24 pixels, un compteur float n'augmente plus exactement : les
+// histogrammes entiers et leur cumul doivent rester exacts
+void testerComptesExacts() {
+    const int cote = 4097;
+    cv::Mat image(cote, cote, CV_8UC1, cv::Scalar(7));
+    image.rowRange(0, 1).setTo(cv::Scalar(200));
+    uint64_t nbSept = static_cast<uint64_t>(cote - 1) * cote;
+
+    HistogrammeEntier<uint32_t> hist32, cumul32;
+    HistogrammeEntier<uint64_t> hist64;
+    calculerHistogramme(image, hist32);
+    calculerHistogramme(image, hist64);
+    hist32.cumuler(cumul32);
+
+    nbVerifications += 3;
+    if (hist32[7] != nbSept || hist32[200] != static_cast<uint32_t>(cote)) {
+        std::cerr << "ECHEC comptes exacts uint32 : " << hist32[7] << " au lieu de " << nbSept << std::endl;
+        ++nbEchecs;
+    }
+    if (hist64[7] != nbSept || hist64.total() != image.total()) {
+        std::cerr << "ECHEC comptes exacts uint64 : " << hist64[7] << " au lieu de " << nbSept << std::endl;
+        ++nbEchecs;
+    }
+    if (cumul32[255] != image.total() || cumul32[7] != nbSept) {
+        std::cerr << "ECHEC cumul exact : " << cumul32[255] << " au lieu de " << image.total() << std::endl;
+        ++nbEchecs;
+    }
+
+    // Assez de pixels pour compter par bandes sur plusieurs threads
+    uint32_t histoBandes[256];
+    calculerHistogrammeBrutParallele(image, histoBandes, 3);
+    ++nbVerifications;
+    if (histoBandes[7] != nbSept || histoBandes[200] != static_cast<uint32_t>(cote)) {
+        std::cerr << "ECHEC comptes par bandes : " << histoBandes[7] << " au lieu de " << nbSept << std::endl;
+        ++nbEchecs;
+    }
+}
+
+// Une image vide donne une image vide, sans division par un nombre de pixels nul
+void testerImageVide() {
+    cv::Mat vide, obtenu, egalisee;
+    egaliseHist(vide, obtenu);
+    egaliserHistogramme(vide, egalisee);
+    ++nbVerifications;
+    if (!obtenu.empty() || !egalisee.empty()) {
+        std::cerr << "ECHEC egalisation d'une image vide : la sortie n'est pas vide" << std::endl;
+        ++nbEchecs;
+    }
+}
+
+void testerEgalisation(const std::string& nom, const cv::Mat& image) {
+    cv::Mat attendu;
+    cv::equalizeHist(image, attendu);
+
+    // OpenCV retire du cumul les pixels de la plus petite intensité présente (h0) :
+    // lut = 255 (cdf - h0) / (N - h0), arrondi, contre 255 cdf / N, tronqué, chez nous.
+    // L'écart est au plus 255 h0 / N, plus 1 pour l'arrondi.
+    cv::Mat hist;
+    histogrammeOpenCV(image, hist);
+    double h0 = 0.0;
+    for (int k = 0; k < 256 && h0 == 0.0; ++k) {
+        h0 = hist.at<float>(0, k);
+    }
+    double tolerance = std::ceil(255.0 * h0 / image.total()) + 1.0;
+
+    cv::Mat obtenu, formule;
+    egaliseHist(image, obtenu);
+    verifierImages(nom + " egaliseHist", obtenu, attendu, tolerance);
+
+    egalizeHistFormule(image, formule);
+    verifierImages(nom + " egalizeHistFormule", formule, obtenu, 0.0);
+
+    // En place, le résultat doit être exactement le même
+    cv::Mat enPlace = image.clone();
+    egaliserHistogrammeFusion(enPlace, enPlace);
+    verifierImages(nom + " egaliserHistogrammeFusion en place", enPlace, obtenu, 0.0);
+}
+
+void testerClahe(const std::string& nom, const cv::Mat& image) {
+    // Mêmes tables que cv::createCLAHE ; l'interpolation en float peut arrondir de 1
+    // différemment selon les instructions vectorielles d'OpenCV
+    const double limites[] = {40.0, 2.0, 0.0};
+    const cv::Size grilles[] = {cv::Size(8, 8), cv::Size(3, 5), cv::Size(1, 1)};
+    for (int i = 0; i < 3; ++i) {
+        std::string nomTest = nom + " CLAHE " + std::to_string(grilles[i].width) + "x"
+                              + std::to_string(grilles[i].height);
+        cv::Mat attendu, obtenu, parallele;
+        cv::createCLAHE(limites[i], grilles[i])->apply(image, attendu);
+        egaliserHistogrammeClahe(image, obtenu, limites[i], grilles[i].width, grilles[i].height, 1);
+        verifierImages(nomTest, obtenu, attendu, 1.0);
+
+        // Le découpage en threads ne change rien au résultat
+        egaliserHistogrammeClahe(image, parallele, limites[i], grilles[i].width, grilles[i].height, 4);
+        verifierImages(nomTest + " 4 threads", parallele, obtenu, 0.0);
+    }
+}
+
+void testerLocal(const std::string& nom, const cv::Mat& image, int rayon) {
+    // Référence : chaque fenêtre est relue en entier, bords par reflet
+    cv::Mat egalisee(image.size(), CV_8UC1), moyenne(image.size(), CV_32FC1), ecartType(image.size(), CV_32FC1);
+    double total = (2 * rayon + 1) * (2 * rayon + 1);
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            int centre = image.at<uchar>(y, x);
+            int inferieurs = 0;
+            double somme = 0.0, sommeCarres = 0.0;
+            for (int dy = -rayon; dy <= rayon; ++dy) {
+                for (int dx = -rayon; dx <= rayon; ++dx) {
+                    int v = image.at<uchar>(cv::borderInterpolate(y + dy, image.rows, cv::BORDER_REFLECT_101),
+                                            cv::borderInterpolate(x + dx, image.cols, cv::BORDER_REFLECT_101));
+                    inferieurs += v <= centre;
+                    somme += v;
+                    sommeCarres += v * v;
+                }
+            }
+            egalisee.at<uchar>(y, x) = static_cast<uchar>(255 * inferieurs / static_cast<int>(total));
+            moyenne.at<float>(y, x) = static_cast<float>(somme / total);
+            ecartType.at<float>(y, x) = static_cast<float>(
+                std::sqrt(std::max(sommeCarres / total - (somme / total) * (somme / total), 0.0)));
+        }
+    }
+
+    std::string nomTest = nom + " rayon " + std::to_string(rayon);
+    cv::Mat obtenu, parallele, moyenneObtenue, ecartTypeObtenu;
+    egaliserHistogrammeLocal(image, obtenu, rayon, 1);
+    verifierImages(nomTest + " egaliserHistogrammeLocal", obtenu, egalisee, 0.0);
+    egaliserHistogrammeLocal(image, parallele, rayon, 4);
+    verifierImages(nomTest + " egaliserHistogrammeLocal 4 threads", parallele, obtenu, 0.0);
+
+    statistiquesLocales(image, moyenneObtenue, ecartTypeObtenu, rayon, 3);
+    verifierImages(nomTest + " moyenne locale", moyenneObtenue, moyenne, 1e-3);
+    verifierImages(nomTest + " ecart-type local", ecartTypeObtenu, ecartType, 1e-2);
+}
+
+void testerMedian(const std::string& nom, const cv::Mat& image, int taille) {
+    // Même bord répliqué que cv::medianBlur : résultat identique, réseau de tri ou
+    // histogramme glissant
+    std::string nomTest = nom + " filtreMedian " + std::to_string(taille) + "x" + std::to_string(taille);
+    cv::Mat attendu;
+    cv::medianBlur(image, attendu, taille);
+    verifierImages(nomTest, filtreMedian(image, taille, BORD_REPLIQUE, 1), attendu, 0.0);
+    verifierImages(nomTest + " 3 threads", filtreMedian(image, taille, BORD_REPLIQUE, 3), attendu, 0.0);
+
+    // Les quantiles 0 et 1 sont l'érosion et la dilatation de la fenêtre
+    cv::Mat minimum, maximum, attenduMin, attenduMax;
+    cv::Mat element = cv::Mat::ones(taille, taille, CV_8UC1);
+    filtreRang(image, minimum, taille / 2, 0.0, BORD_REPLIQUE, 2);
+    filtreRang(image, maximum, taille / 2, 1.0, BORD_REPLIQUE, 2);
+    cv::erode(image, attenduMin, element, cv::Point(-1, -1), 1, cv::BORDER_REPLICATE);
+    cv::dilate(image, attenduMax, element, cv::Point(-1, -1), 1, cv::BORDER_REPLICATE);
+    verifierImages(nomTest + " filtreRang minimum", minimum, attenduMin, 0.0);
+    verifierImages(nomTest + " filtreRang maximum", maximum, attenduMax, 0.0);
+}
+
+void testerGaussRecursif(const std::string& nom, const cv::Mat& image, double sigma) {
+    // Le filtre récursif approche la gaussienne : à partir de sigma = 3, moins de 1 % de
+    // la dynamique d'écart avec cv::GaussianBlur en bords répliqués
+    std::string nomTest = nom + " flouGaussienRecursif sigma " + std::to_string(sigma);
+    cv::Mat flottante, attendu;
+    image.convertTo(flottante, CV_32F, 1.0 / 255.0);
+    cv::GaussianBlur(flottante, attendu, cv::Size(0, 0), sigma, sigma, cv::BORDER_REPLICATE);
+    cv::Mat obtenu = flouGaussienRecursif(flottante, sigma, 1);
+    verifierImages(nomTest, obtenu, attendu, 0.01);
+    verifierImages(nomTest + " 3 threads", flouGaussienRecursif(flottante, sigma, 3), obtenu, 0.0);
+
+    // Les canaux sont filtrés chacun de leur côté, et une image uniforme ne bouge pas
+    cv::Mat gris = flouGaussienRecursif(image, sigma, 1), couleur;
+    std::vector<cv::Mat> canaux(3, image);
+    cv::merge(canaux, couleur);
+    std::vector<cv::Mat> canauxFloutes;
+    cv::split(flouGaussienRecursif(couleur, sigma, 2), canauxFloutes);
+    for (size_t c = 0; c < canauxFloutes.size(); ++c) {
+        verifierImages(nomTest + " canal " + std::to_string(c), canauxFloutes[c], gris, 0.0);
+    }
+    cv::Mat uniforme(image.size(), CV_8UC1, cv::Scalar(77));
+    verifierImages(nomTest + " image uniforme", flouGaussienRecursif(uniforme, sigma, 1), uniforme, 0.0);
+}
+
+// Critère d'Otsu des seuils donnés (somme des carrés des sommes de niveaux divisés par
+// les effectifs des classes), en double sur les comptes exacts ; pixels et niveaux sont
+// les sommes cumulées sur 257 cases
+double critereOtsu(const std::vector<double>& pixels, const std::vector<double>& niveaux, const std::vector<int>& seuils) {
+    double critere = 0.0;
+    int debut = 0;
+    for (size_t k = 0; k <= seuils.size(); ++k) {
+        int fin = k < seuils.size() ? seuils[k] + 1 : 256;
+        double nombre = pixels[fin] - pixels[debut];
+        if (nombre > 0.0) {
+            critere += (niveaux[fin] - niveaux[debut]) * (niveaux[fin] - niveaux[debut]) / nombre;
+        }
+        debut = fin;
+    }
+    return critere;
+}
+
+// Meilleur critère sur tous les seuils possibles, en les essayant tous
+double critereOtsuExhaustif(const std::vector<double>& pixels, const std::vector<double>& niveaux,
+                            std::vector<int>& seuils, size_t k) {
+    if (k == seuils.size()) {
+        return critereOtsu(pixels, niveaux, seuils);
+    }
+    double meilleur = 0.0;
+    int premier = k == 0 ? 0 : seuils[k - 1] + 1;
+    for (int t = premier; t <= 255 - static_cast<int>(seuils.size() - k); ++t) {
+        seuils[k] = t;
+        meilleur = std::max(meilleur, critereOtsuExhaustif(pixels, niveaux, seuils, k + 1));
+    }
+    return meilleur;
+}
+
+void testerOtsu(const std::string& nom, const cv::Mat& image) {
+    cv::Mat hist;
+    monCalcHist(image, hist);
+    std::vector<double> pixels(257, 0.0), niveaux(257, 0.0);
+    for (int v = 0; v < 256; ++v) {
+        pixels[v + 1] = pixels[v] + hist.at<float>(0, v);
+        niveaux[v + 1] = niveaux[v] + static_cast<double>(hist.at<float>(0, v)) * v;
+    }
+
+    // Deux classes : exactement le seuil de cv::threshold, et la même image binaire
+    cv::Mat attendu, obtenu;
+    int seuilAttendu = static_cast<int>(cv::threshold(image, attendu, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU));
+    std::vector<int> seuils;
+    segmenterOtsu(image, obtenu, 2, seuils);
+    verifierImages(nom + " seuilOtsu", cv::Mat(1, 1, CV_32S, cv::Scalar(seuils[0])),
+                   cv::Mat(1, 1, CV_32S, cv::Scalar(seuilAttendu)), 0.0);
+    verifierImages(nom + " segmenterOtsu", obtenu, attendu, 0.0);
+
+    // Trois et quatre classes : le critère de la recherche exhaustive, et la table
+    // appliquée pixel par pixel
+    for (int nbClasses = 3; nbClasses <= NB_CLASSES_OTSU_MAX; ++nbClasses) {
+        std::string nomTest = nom + " Otsu " + std::to_string(nbClasses) + " classes";
+        segmenterOtsu(image, obtenu, nbClasses, seuils);
+        std::vector<int> essai(nbClasses - 1);
+        double meilleur = critereOtsuExhaustif(pixels, niveaux, essai, 0);
+        verifierImages(nomTest + " critere", cv::Mat(1, 1, CV_64F, cv::Scalar(critereOtsu(pixels, niveaux, seuils))),
+                       cv::Mat(1, 1, CV_64F, cv::Scalar(meilleur)), 1e-6 * meilleur);
+
+        cv::Mat formule(image.size(), CV_8UC1);
+        for (int y = 0; y < image.rows; ++y) {
+            for (int x = 0; x < image.cols; ++x) {
+                int classe = 0;
+                while (classe < nbClasses - 1 && image.at<uchar>(y, x) > seuils[classe]) {
+                    ++classe;
+                }
+                formule.at<uchar>(y, x) = static_cast<uchar>(cvRound(255.0 * classe / (nbClasses - 1)));
+            }
+        }
+        verifierImages(nomTest + " appliquerSeuils", obtenu, formule, 0.0);
+    }
+}
+
+// Proportion de pixels différents entre deux images binaires
+double proportionDifferente(const cv::Mat& a, const cv::Mat& b) {
+    int nbDifferents = 0;
+    for (int y = 0; y < a.rows; ++y) {
+        for (int x = 0; x < a.cols; ++x) {
+            nbDifferents += a.at<uchar>(y, x) != b.at<uchar>(y, x);
+        }
+    }
+    return a.empty() ? 0.0 : static_cast<double>(nbDifferents) / a.total();
+}
+
+void testerSeuillageAdaptatif(const std::string& nom, const cv::Mat& image, int taille) {
+    std::string nomTest = nom + " seuillageAdaptatif " + std::to_string(taille);
+
+    // Moyenne : le résultat de cv::adaptiveThreshold, C entier ou non, binaire ou inversé
+    const double constantes[] = {5.0, 2.5, -3.0};
+    cv::Mat attendu, obtenu;
+    for (int c = 0; c < 3; ++c) {
+        for (int inverser = 0; inverser <= 1; ++inverser) {
+            std::string nomMoyenne = nomTest + " moyenne C " + std::to_string(constantes[c])
+                                     + (inverser ? " inverse" : "");
+            OptionsSeuillage options(SEUIL_MOYENNE, taille);
+            options.C = constantes[c];
+            options.inverser = inverser != 0;
+            cv::adaptiveThreshold(image, attendu, 255, cv::ADAPTIVE_THRESH_MEAN_C,
+                                  inverser ? cv::THRESH_BINARY_INV : cv::THRESH_BINARY, taille, constantes[c]);
+            seuillageAdaptatif(image, obtenu, options, 1);
+            verifierImages(nomMoyenne, obtenu, attendu, 0.0);
+            seuillageAdaptatif(image, obtenu, options, 3);
+            verifierImages(nomMoyenne + " 3 threads", obtenu, attendu, 0.0);
+        }
+    }
+
+    // Gaussien : la moyenne pondérée peut différer d'un niveau (arrondi, filtre récursif
+    // au-delà de 17 x 17), ce qui ne retourne que les pixels tout près de leur seuil
+    OptionsSeuillage gaussien(SEUIL_GAUSSIEN, taille);
+    cv::adaptiveThreshold(image, attendu, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, taille, gaussien.C);
+    seuillageAdaptatif(image, obtenu, gaussien, 2);
+    verifierImages(nomTest + " gaussien pixels differents",
+                   cv::Mat(1, 1, CV_64F, cv::Scalar(proportionDifferente(obtenu, attendu))),
+                   cv::Mat(1, 1, CV_64F, cv::Scalar(0.0)), 0.01);
+
+    // Niblack et Sauvola : la formule appliquée à chaque fenêtre parcourue en entier
+    const MethodeSeuillage methodes[] = {SEUIL_NIBLACK, SEUIL_SAUVOLA};
+    for (int m = 0; m < 2; ++m) {
+        OptionsSeuillage options(methodes[m], taille);
+        options.inverser = m == 1;
+        cv::Mat formule(image.size(), CV_8UC1);
+        double inverseNombre = 1.0 / (static_cast<double>(taille) * taille);
+        for (int y = 0; y < image.rows; ++y) {
+            for (int x = 0; x < image.cols; ++x) {
+                double somme = 0.0, sommeCarres = 0.0;
+                for (int dy = -taille / 2; dy <= taille / 2; ++dy) {
+                    for (int dx = -taille / 2; dx <= taille / 2; ++dx) {
+                        double v = image.at<uchar>(std::min(std::max(y + dy, 0), image.rows - 1),
+                                                   std::min(std::max(x + dx, 0), image.cols - 1));
+                        somme += v;
+                        sommeCarres += v * v;
+                    }
+                }
+                double moyenne = somme * inverseNombre;
+                double s = std::sqrt(std::max(sommeCarres * inverseNombre - moyenne * moyenne, 0.0));
+                double seuil = methodes[m] == SEUIL_NIBLACK ? moyenne + options.k * s
+                                                            : moyenne * (1.0 + options.k * (s * (1.0 / options.R) - 1.0));
+                formule.at<uchar>(y, x) = ((image.at<uchar>(y, x) > seuil) != options.inverser) ? 255 : 0;
+            }
+        }
+        std::string nomMethode = nomTest + (methodes[m] == SEUIL_NIBLACK ? " Niblack" : " Sauvola inverse");
+        seuillageAdaptatif(image, obtenu, options, 1);
+        verifierImages(nomMethode, obtenu, formule, 0.0);
+        seuillageAdaptatif(image, obtenu, options, 3);
+        verifierImages(nomMethode + " 3 threads", obtenu, formule, 0.0);
+    }
+}
+
+// Étiquettes et statistiques comparées à cv::connectedComponentsWithStats, à une
+// renumérotation près : chaque étiquette doit correspondre à une seule étiquette OpenCV
+void testerEtiquetage(const std::string& nom, const cv::Mat& binaire) {
+    const int connexites[] = {4, 8};
+    for (int c = 0; c < 2; ++c) {
+        std::string nomTest = nom + " etiquetage connexite " + std::to_string(connexites[c]);
+        cv::Mat attendu, statsOpenCV, centresOpenCV;
+        int nbAttendu = cv::connectedComponentsWithStats(binaire, attendu, statsOpenCV, centresOpenCV,
+                                                         connexites[c]) - 1;
+        cv::Mat obtenu;
+        std::vector<Composante> composantes;
+        int nombre = etiqueterComposantes(binaire, obtenu, composantes, connexites[c], 1);
+        verifierImages(nomTest + " nombre", cv::Mat(1, 1, CV_64F, cv::Scalar(nombre)),
+                       cv::Mat(1, 1, CV_64F, cv::Scalar(nbAttendu)), 0.0);
+        if (nombre != nbAttendu || static_cast<int>(composantes.size()) != nombre) {
+            continue;
+        }
+
+        // Chaque étiquette prend celle d'OpenCV de son premier pixel
+        std::vector<int> versOpenCV(nombre + 1, -1);
+        versOpenCV[0] = 0;
+        cv::Mat renumerote(obtenu.size(), CV_32S);
+        for (int y = 0; y < obtenu.rows; ++y) {
+            for (int x = 0; x < obtenu.cols; ++x) {
+                int& correspondante = versOpenCV[obtenu.at<int>(y, x)];
+                if (correspondante < 0) {
+                    correspondante = attendu.at<int>(y, x);
+                }
+                renumerote.at<int>(y, x) = correspondante;
+            }
+        }
+        verifierImages(nomTest, renumerote, attendu, 0.0);
+
+        // Statistiques rangées dans l'ordre d'OpenCV : gauche, haut, largeur, hauteur,
+        // aire, centre
+        cv::Mat stats(nombre, 7, CV_64F, cv::Scalar(0.0)), statsAttendues(nombre, 7, CV_64F);
+        for (int e = 1; e <= nombre; ++e) {
+            for (int j = 0; j < 5; ++j) {
+                statsAttendues.at<double>(e - 1, j) = statsOpenCV.at<int>(e, j);
+            }
+            statsAttendues.at<double>(e - 1, 5) = centresOpenCV.at<double>(e, 0);
+            statsAttendues.at<double>(e - 1, 6) = centresOpenCV.at<double>(e, 1);
+            if (versOpenCV[e] <= 0) {
+                continue;
+            }
+            const Composante& composante = composantes[e - 1];
+            double* ligne = stats.ptr<double>(versOpenCV[e] - 1);
+            ligne[cv::CC_STAT_LEFT] = composante.boite.x;
+            ligne[cv::CC_STAT_TOP] = composante.boite.y;
+            ligne[cv::CC_STAT_WIDTH] = composante.boite.width;
+            ligne[cv::CC_STAT_HEIGHT] = composante.boite.height;
+            ligne[cv::CC_STAT_AREA] = composante.aire;
+            ligne[5] = composante.centre.x;
+            ligne[6] = composante.centre.y;
+        }
+        verifierImages(nomTest + " statistiques", stats, statsAttendues, 1e-9);
+
+        // Les bandes en parallèle donnent exactement les mêmes étiquettes, avec ou sans
+        // statistiques
+        const int nbThreads[] = {3, 7};
+        for (int t = 0; t < 2; ++t) {
+            std::string nomThreads = nomTest + " " + std::to_string(nbThreads[t]) + " threads";
+            cv::Mat parallele;
+            std::vector<Composante> composantesParallele;
+            etiqueterComposantes(binaire, parallele, composantesParallele, connexites[c], nbThreads[t]);
+            verifierImages(nomThreads, parallele, obtenu, 0.0);
+            bool memesStatistiques = composantesParallele.size() == composantes.size();
+            for (size_t e = 0; memesStatistiques && e < composantes.size(); ++e) {
+                memesStatistiques = composantesParallele[e].aire == composantes[e].aire
+                                    && composantesParallele[e].boite == composantes[e].boite
+                                    && composantesParallele[e].centre == composantes[e].centre;
+            }
+            verifierImages(nomThreads + " statistiques", cv::Mat(1, 1, CV_64F, cv::Scalar(memesStatistiques)),
+                           cv::Mat(1, 1, CV_64F, cv::Scalar(1.0)), 0.0);
+            etiqueterComposantes(binaire, parallele, connexites[c], nbThreads[t]);
+            verifierImages(nomThreads + " sans statistiques", parallele, obtenu, 0.0);
+        }
+    }
+}
+
+// Croissance de référence : une std::priority_queue ordonnée par (niveau, ordre
+// d'arrivée) à la place de la file à 256 niveaux, sur l'image sans bordure. Les germes
+// (pixel, région) entrent dans la file dans l'ordre donné.
+cv::Mat croissanceReference(const cv::Mat& image, const std::vector<std::pair<cv::Point, int> >& germes,
+                            int nbRegions, int connexite, double tolerance) {
+    typedef std::pair<std::pair<int, long>, std::pair<int, int> > Entree;
+    std::priority_queue<Entree, std::vector<Entree>, std::greater<Entree> > file;
+    cv::Mat etiquettes(image.size(), CV_32S, cv::Scalar(0));
+    std::vector<double> sommes(nbRegions + 1, 0.0), nombres(nbRegions + 1, 0.0), moyennes(nbRegions + 1, 0.0);
+    long ordre = 0;
+    for (size_t i = 0; i < germes.size(); ++i) {
+        const cv::Point& germe = germes[i].first;
+        if (etiquettes.at<int>(germe.y, germe.x) != 0) {
+            continue;
+        }
+        etiquettes.at<int>(germe.y, germe.x) = germes[i].second;
+        moyennes[germes[i].second] += image.at<uchar>(germe.y, germe.x);
+        nombres[germes[i].second] += 1.0;
+        file.push(Entree(std::make_pair(0, ordre++), std::make_pair(germe.x, germe.y)));
+    }
+    for (int r = 1; r <= nbRegions; ++r) {
+        if (nombres[r] > 0.0) {
+            moyennes[r] /= nombres[r];
+            nombres[r] = 0.0;
+        }
+    }
+
+    const int dx[] = {-1, 1, 0, 0, -1, 1, -1, 1};
+    const int dy[] = {0, 0, -1, 1, -1, -1, 1, 1};
+    while (!file.empty()) {
+        int x = file.top().second.first;
+        int y = file.top().second.second;
+        file.pop();
+        int r = etiquettes.at<int>(y, x);
+        sommes[r] += image.at<uchar>(y, x);
+        nombres[r] += 1.0;
+        moyennes[r] = sommes[r] / nombres[r];
+        for (int k = 0; k < connexite; ++k) {
+            int qx = x + dx[k], qy = y + dy[k];
+            if (qx < 0 || qy < 0 || qx >= image.cols || qy >= image.rows || etiquettes.at<int>(qy, qx) != 0) {
+                continue;
+            }
+            double ecart = std::abs(image.at<uchar>(qy, qx) - moyennes[r]);
+            if (ecart <= tolerance) {
+                etiquettes.at<int>(qy, qx) = r;
+                file.push(Entree(std::make_pair(static_cast<int>(ecart + 0.5), ordre++), std::make_pair(qx, qy)));
+            }
+        }
+    }
+    return etiquettes;
+}
+
+// Comparée à la référence, une file à 256 niveaux doit donner exactement les mêmes
+// régions
+void testerCroissance(const std::string& nom, const cv::Mat& image, cv::RNG& rng) {
+    // Plusieurs régions en concurrence, dont un germe en double qui reste à la première
+    std::vector<cv::Point> germes;
+    for (int i = 0; i < 6; ++i) {
+        germes.push_back(cv::Point(rng.uniform(0, image.cols), rng.uniform(0, image.rows)));
+    }
+    germes.push_back(germes[2]);
+    std::vector<std::pair<cv::Point, int> > unSeul(1, std::make_pair(germes[0], 1)), chacun;
+    for (size_t i = 0; i < germes.size(); ++i) {
+        chacun.push_back(std::make_pair(germes[i], static_cast<int>(i + 1)));
+    }
+
+    // Des marqueurs de deux pixels par région (sauf si deux germes tombent au même
+    // endroit) : les germes entrent dans la file dans l'ordre des lignes
+    cv::Mat marqueurs(image.size(), CV_32S, cv::Scalar(0));
+    for (int i = 0; i < 6; ++i) {
+        marqueurs.at<int>(germes[i].y, germes[i].x) = i / 2 + 1;
+    }
+    std::vector<std::pair<cv::Point, int> > germesMarqueurs;
+    for (int y = 0; y < marqueurs.rows; ++y) {
+        for (int x = 0; x < marqueurs.cols; ++x) {
+            if (marqueurs.at<int>(y, x) > 0) {
+                germesMarqueurs.push_back(std::make_pair(cv::Point(x, y), marqueurs.at<int>(y, x)));
+            }
+        }
+    }
+
+    // La tolérance par défaut : facteur x écart-type de l'histogramme de monCalcHist
+    cv::Mat hist;
+    monCalcHist(image, hist);
+    double nombre = 0.0, somme = 0.0, sommeCarres = 0.0;
+    for (int v = 0; v < 256; ++v) {
+        nombre += hist.at<float>(0, v);
+        somme += static_cast<double>(hist.at<float>(0, v)) * v;
+        sommeCarres += static_cast<double>(hist.at<float>(0, v)) * v * v;
+    }
+    double moyenne = somme / nombre;
+    double toleranceDefaut = OptionsCroissance().facteur
+                             * std::sqrt(std::max(sommeCarres / nombre - moyenne * moyenne, 0.0));
+
+    const double tolerances[] = {0.0, 4.0, 25.0};
+    for (int c = 4; c <= 8; c += 4) {
+        for (int t = 0; t < 3; ++t) {
+            OptionsCroissance options;
+            options.connexite = c;
+            options.tolerance = tolerances[t];
+            double tolerance = tolerances[t] > 0.0 ? tolerances[t] : toleranceDefaut;
+            std::string nomTest = nom + " croissance connexite " + std::to_string(c) + " tolerance "
+                                  + std::to_string(tolerance);
+            cv::Mat obtenu;
+            croissanceRegions(image, std::vector<cv::Point>(1, germes[0]), obtenu, options);
+            verifierImages(nomTest + " 1 germe", obtenu, croissanceReference(image, unSeul, 1, c, tolerance), 0.0);
+            croissanceRegions(image, germes, obtenu, options);
+            verifierImages(nomTest + " 7 germes", obtenu,
+                           croissanceReference(image, chacun, static_cast<int>(germes.size()), c, tolerance), 0.0);
+            cv::Mat etiquettes = marqueurs.clone();
+            croissanceRegions(image, etiquettes, etiquettes, options);
+            verifierImages(nomTest + " marqueurs", etiquettes,
+                           croissanceReference(image, germesMarqueurs, 3, c, tolerance), 0.0);
+        }
+    }
+}
+
+// Le gradient de Sobel comparé à cv::Sobel avec bords répliqués, ramené sur 0..255
+void testerGradientSobel(const std::string& nom, const cv::Mat& image) {
+    cv::Mat gx, gy;
+    cv::Sobel(image, gx, CV_32F, 1, 0, 3, 1.0, 0.0, cv::BORDER_REPLICATE);
+    cv::Sobel(image, gy, CV_32F, 0, 1, 3, 1.0, 0.0, cv::BORDER_REPLICATE);
+    cv::Mat norme(image.size(), CV_64F);
+    double maximum = 0.0;
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            double gxv = gx.at<float>(y, x), gyv = gy.at<float>(y, x);
+            norme.at<double>(y, x) = std::sqrt(gxv * gxv + gyv * gyv);
+            maximum = std::max(maximum, norme.at<double>(y, x));
+        }
+    }
+    cv::Mat attendu(image.size(), CV_8UC1);
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            attendu.at<uchar>(y, x) = cv::saturate_cast<uchar>(maximum > 0.0 ? norme.at<double>(y, x) * 255.0 / maximum
+                                                                              : 0.0);
+        }
+    }
+    verifierImages(nom + " gradientSobel", gradientSobel(image), attendu, 1.0);
+}
+
+// Inondation de référence : une std::priority_queue ordonnée par (niveau, ordre
+// d'arrivée), les marqueurs au niveau 0 dans l'ordre des lignes, les voisins à gauche,
+// à droite, en haut puis en bas
+cv::Mat partageReference(const cv::Mat& relief, const cv::Mat& marqueurs) {
+    typedef std::pair<std::pair<int, long>, std::pair<int, int> > Entree;
+    std::priority_queue<Entree, std::vector<Entree>, std::greater<Entree> > file;
+    cv::Mat etiquettes(relief.size(), CV_32S, cv::Scalar(0));
+    long ordre = 0;
+    for (int y = 0; y < relief.rows; ++y) {
+        for (int x = 0; x < relief.cols; ++x) {
+            if (marqueurs.at<int>(y, x) > 0) {
+                etiquettes.at<int>(y, x) = marqueurs.at<int>(y, x);
+                file.push(Entree(std::make_pair(0, ordre++), std::make_pair(x, y)));
+            }
+        }
+    }
+    const int dx[] = {-1, 1, 0, 0};
+    const int dy[] = {0, 0, -1, 1};
+    while (!file.empty()) {
+        int niveau = file.top().first.first;
+        int x = file.top().second.first;
+        int y = file.top().second.second;
+        file.pop();
+        for (int k = 0; k < 4; ++k) {
+            int qx = x + dx[k], qy = y + dy[k];
+            if (qx < 0 || qy < 0 || qx >= relief.cols || qy >= relief.rows || etiquettes.at<int>(qy, qx) != 0) {
+                continue;
+            }
+            etiquettes.at<int>(qy, qx) = etiquettes.at<int>(y, x);
+            file.push(Entree(std::make_pair(std::max(niveau, static_cast<int>(relief.at<uchar>(qy, qx))), ordre++),
+                             std::make_pair(qx, qy)));
+        }
+    }
+    return etiquettes;
+}
+
+// Niveau auquel l'eau partie des marqueurs d'étiquette donnée (toutes si etiquette vaut
+// 0) atteint chaque pixel : le plus petit maximum du relief sur un chemin 4-connexe
+cv::Mat niveauxInondation(const cv::Mat& relief, const cv::Mat& marqueurs, int etiquette) {
+    typedef std::pair<int, std::pair<int, int> > Entree;
+    std::priority_queue<Entree, std::vector<Entree>, std::greater<Entree> > file;
+    cv::Mat niveaux(relief.size(), CV_32S, cv::Scalar(INT32_MAX));
+    for (int y = 0; y < relief.rows; ++y) {
+        for (int x = 0; x < relief.cols; ++x) {
+            int m = marqueurs.at<int>(y, x);
+            if (m > 0 && (etiquette == 0 || m == etiquette)) {
+                niveaux.at<int>(y, x) = 0;
+                file.push(Entree(0, std::make_pair(x, y)));
+            }
+        }
+    }
+    const int dx[] = {-1, 1, 0, 0};
+    const int dy[] = {0, 0, -1, 1};
+    while (!file.empty()) {
+        int niveau = file.top().first;
+        int x = file.top().second.first;
+        int y = file.top().second.second;
+        file.pop();
+        if (niveau != niveaux.at<int>(y, x)) {
+            continue;
+        }
+        for (int k = 0; k < 4; ++k) {
+            int qx = x + dx[k], qy = y + dy[k];
+            if (qx < 0 || qy < 0 || qx >= relief.cols || qy >= relief.rows) {
+                continue;
+            }
+            int atteint = std::max(niveau, static_cast<int>(relief.at<uchar>(qy, qx)));
+            if (atteint < niveaux.at<int>(qy, qx)) {
+                niveaux.at<int>(qy, qx) = atteint;
+                file.push(Entree(atteint, std::make_pair(qx, qy)));
+            }
+        }
+    }
+    return niveaux;
+}
+
+// Chaque pixel doit appartenir à un bassin qui l'atteint au plus bas niveau possible
+// (seuls les ex aequo sur un plateau peuvent départager les tuiles autrement)
+void verifierNiveauxPartage(const std::string& nom, const cv::Mat& etiquettes, const cv::Mat& niveauxMin,
+                            const std::vector<cv::Mat>& niveauxParEtiquette) {
+    ++nbVerifications;
+    for (int y = 0; y < etiquettes.rows; ++y) {
+        for (int x = 0; x < etiquettes.cols; ++x) {
+            int e = etiquettes.at<int>(y, x);
+            bool correct = e >= 0 && e < static_cast<int>(niveauxParEtiquette.size())
+                           && (e == 0 ? niveauxMin.at<int>(y, x) == INT32_MAX
+                                      : niveauxParEtiquette[e].at<int>(y, x) == niveauxMin.at<int>(y, x));
+            if (!correct) {
+                std::cerr << "ECHEC " << nom << " : le pixel (" << x << ", " << y << ") d'etiquette " << e
+                          << " n'est pas atteint au plus bas niveau " << niveauxMin.at<int>(y, x) << std::endl;
+                ++nbEchecs;
+                return;
+            }
+        }
+    }
+}
+
+void testerPartage(const std::string& nom, const cv::Mat& image, cv::RNG& rng) {
+    testerGradientSobel(nom, image);
+    cv::Mat relief = gradientSobel(image);
+
+    // Quelques marqueurs d'un ou deux pixels, et un pixel à -1 inondé comme un autre
+    const int nbEtiquettes = 4;
+    cv::Mat marqueurs(image.size(), CV_32S, cv::Scalar(0));
+    for (int i = 0; i < 2 * nbEtiquettes; ++i) {
+        marqueurs.at<int>(rng.uniform(0, image.rows), rng.uniform(0, image.cols)) = i / 2 + 1;
+    }
+    marqueurs.at<int>(rng.uniform(0, image.rows), rng.uniform(0, image.cols)) = -1;
+
+    cv::Mat sequentiel = marqueurs.clone();
+    ligneDePartageEaux(relief, sequentiel);
+    verifierImages(nom + " ligneDePartageEaux", sequentiel, partageReference(relief, marqueurs), 0.0);
+
+    // Une seule tuile : c'est exactement l'inondation séquentielle
+    cv::Mat uneTuile = marqueurs.clone();
+    ligneDePartageEauxTuiles(relief, uneTuile, std::max(image.rows, image.cols), 3);
+    verifierImages(nom + " ligneDePartageEauxTuiles 1 tuile", uneTuile, sequentiel, 0.0);
+
+    cv::Mat niveauxMin = niveauxInondation(relief, marqueurs, 0);
+    std::vector<cv::Mat> niveauxParEtiquette(1);
+    for (int e = 1; e <= nbEtiquettes; ++e) {
+        niveauxParEtiquette.push_back(niveauxInondation(relief, marqueurs, e));
+    }
+    verifierNiveauxPartage(nom + " ligneDePartageEaux niveaux", sequentiel, niveauxMin, niveauxParEtiquette);
+
+    const int taillesTuiles[] = {7, 16, 64};
+    for (int t = 0; t < 3; ++t) {
+        std::string nomTest = nom + " ligneDePartageEauxTuiles " + std::to_string(taillesTuiles[t]);
+        cv::Mat unThread = marqueurs.clone(), plusieurs = marqueurs.clone();
+        ligneDePartageEauxTuiles(relief, unThread, taillesTuiles[t], 1);
+        ligneDePartageEauxTuiles(relief, plusieurs, taillesTuiles[t], 3);
+        verifierImages(nomTest + " 1 contre 3 threads", plusieurs, unThread, 0.0);
+        verifierNiveauxPartage(nomTest + " niveaux", unThread, niveauxMin, niveauxParEtiquette);
+    }
+}
+
+void testerEtirement(const std::string& nom, const cv::Mat& image) {
+    double minVal, maxVal;
+    minMaxIm(image, minVal, maxVal);
+    if (minVal == maxVal) {
+        return;
+    }
+
+    // normalize arrondit, etirerHistogramme tronque : au plus 1 d'écart
+    cv::Mat attendu, obtenu;
+    cv::normalize(image, attendu, 0, 255, cv::NORM_MINMAX, CV_8U);
+    etirerHistogramme(image, obtenu, 0, 255);
+    verifierImages(nom + " etirerHistogramme", obtenu, attendu, 1.0);
+
+    // Avec l'histogramme déjà calculé, et vers une autre plage : même table, même résultat
+    // que la formule d'origine appliquée pixel par pixel
+    cv::Mat hist, avecHistogramme, formule(image.size(), CV_8UC1);
+    monCalcHist(image, hist);
+    etirerHistogramme(image, avecHistogramme, 10, 100, hist);
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            formule.at<uchar>(y, x) = static_cast<uchar>(
+                static_cast<int>(90.0 * (image.at<uchar>(y, x) - minVal) / (maxVal - minVal) + 10));
+        }
+    }
+    verifierImages(nom + " etirerHistogramme avec histogramme", avecHistogramme, formule, 0.0);
+
+    // Centiles 0 et 1 : les bornes lues dans le cumul sont le minimum et le maximum
+    cv::Mat histCumule, sansSaturation;
+    calculerHistogrammeCumule(hist, histCumule);
+    etirerHistogrammePercentiles(image, sansSaturation, 10, 100, histCumule, 0.0, 1.0);
+    verifierImages(nom + " etirerHistogrammePercentiles 0-100", sansSaturation, formule, 0.0);
+
+    // Centiles 1 et 99 : bornes de référence prises dans les pixels triés, saturation
+    // en dehors
+    std::vector<uchar> tries;
+    for (int y = 0; y < image.rows; ++y) {
+        tries.insert(tries.end(), image.ptr<uchar>(y), image.ptr<uchar>(y) + image.cols);
+    }
+    std::sort(tries.begin(), tries.end());
+    double n = static_cast<double>(tries.size());
+    int bas = tries[static_cast<size_t>(std::floor(0.01 * n))];
+    int haut = std::max(bas, static_cast<int>(tries[static_cast<size_t>(std::ceil(0.99 * n)) - 1]));
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            int v = image.at<uchar>(y, x);
+            double valeur = v > haut ? 255.0 : (v >= bas && haut > bas ? 255.0 * (v - bas) / (haut - bas) : 0.0);
+            formule.at<uchar>(y, x) = static_cast<uchar>(static_cast<int>(valeur));
+        }
+    }
+    cv::Mat sature;
+    etirerHistogrammePercentiles(image, sature, 0, 255);
+    verifierImages(nom + " etirerHistogrammePercentiles 1-99", sature, formule, 0.0);
+}
+
+int bordOpenCV(ModeBord mode) {
+    switch (mode) {
+        case BORD_REPLIQUE:
+            return cv::BORDER_REPLICATE;
+        case BORD_REFLET:
+            return cv::BORDER_REFLECT;
+        case BORD_CONSTANT:
+            return cv::BORDER_CONSTANT;
+        default:
+            return cv::BORDER_REFLECT_101;
+    }
+}
+
+void testerFiltre(const std::string& nom, const cv::Mat& image, const cv::Mat& filtre) {
+    // filter2D ne connaît pas le bord cyclique, et sa constante vaut toujours 0
+    const ModeBord modes[] = {BORD_REPLIQUE, BORD_REFLET, BORD_REFLET_101, BORD_CONSTANT};
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        std::string nomTest = nom + " filtre " + std::to_string(filtre.rows) + "x" + std::to_string(filtre.cols)
+                              + " bord " + std::to_string(static_cast<int>(modes[m]));
+
+        // Sortie 8 bits saturée : virgule fixe, au plus 1 d'écart avec l'arrondi d'OpenCV
+        cv::Mat attendu;
+        cv::filter2D(image, attendu, CV_8U, filtre, cv::Point(-1, -1), 0, bordOpenCV(modes[m]));
+        verifierImages(nomTest + " CV_8U", appliquerFiltre(image, filtre, modes[m]), attendu, 1.0);
+
+        // Sorties signées et flottantes
+        OptionsFiltre options;
+        options.bord = modes[m];
+        options.profondeurSortie = CV_16S;
+        cv::Mat attendu16, attendu32;
+        cv::filter2D(image, attendu16, CV_16S, filtre, cv::Point(-1, -1), 0, bordOpenCV(modes[m]));
+        verifierImages(nomTest + " CV_16S", appliquerFiltre(image, filtre, options), attendu16, 1.0);
+
+        options.profondeurSortie = CV_32F;
+        cv::filter2D(image, attendu32, CV_32F, filtre, cv::Point(-1, -1), 0, bordOpenCV(modes[m]));
+        verifierImages(nomTest + " CV_32F", appliquerFiltre(image, filtre, options), attendu32, 1e-3);
+
+        // Valeur absolue fusionnée, saturée en 8 bits
+        options.profondeurSortie = CV_8U;
+        options.operation = SORTIE_VALEUR_ABSOLUE;
+        cv::Mat attenduAbs = cv::abs(attendu32);
+        attenduAbs.convertTo(attenduAbs, CV_8U);
+        verifierImages(nomTest + " valeur absolue", appliquerFiltre(image, filtre, options), attenduAbs, 1.0);
+    }
+
+    // Ancien comportement : seul l'intérieur est calculé, le cadre reste à zéro
+    int rayonY = filtre.rows / 2;
+    int rayonX = filtre.cols / 2;
+    if (image.rows > 2 * rayonY && image.cols > 2 * rayonX) {
+        cv::Rect interieur(rayonX, rayonY, image.cols - 2 * rayonX, image.rows - 2 * rayonY);
+        cv::Mat attendu;
+        cv::filter2D(image, attendu, CV_8U, filtre);
+        cv::Mat obtenu = appliquerFiltre(image, filtre, BORD_ZERO_CADRE);
+        verifierImages(nom + " filtre cadre interieur", obtenu(interieur), attendu(interieur), 1.0);
+        obtenu(interieur).setTo(cv::Scalar(0));
+        ++nbVerifications;
+        if (cv::countNonZero(obtenu) != 0) {
+            std::cerr << "ECHEC " << nom << " filtre cadre : le cadre n'est pas a zero" << std::endl;
+            ++nbEchecs;
+        }
+    }
+}
+
+std::vector<cv::Mat> filtresTest(cv::RNG& rng) {
+    std::vector<cv::Mat> filtres;
+    filtres.push_back((cv::Mat_<double>(3, 3) << -1, -1, -1, -1, 8, -1, -1, -1, -1));
+    filtres.push_back((cv::Mat_<double>(3, 3) << -1, 0, 1, -2, 0, 2, -1, 0, 1));
+    filtres.push_back(cv::Mat(3, 3, CV_64F, cv::Scalar(1.0 / 9)));
+    filtres.push_back(cv::Mat(15, 15, CV_64F, cv::Scalar(1.0 / 225)));
+
+    cv::Mat aleatoire(5, 7, CV_64F);
+    rng.fill(aleatoire, cv::RNG::UNIFORM, cv::Scalar(-0.5), cv::Scalar(0.5));
+    filtres.push_back(aleatoire);
+    return filtres;
+}
+
+// Histogramme de référence d'un canal, case par case, sur [0, borneMax[
+cv::Mat histogrammeReference(const cv::Mat& canal, int nbBins, double borneMax) {
+    cv::Mat valeurs;
+    canal.convertTo(valeurs, CV_64F);
+    cv::Mat hist = cv::Mat::zeros(1, nbBins, CV_32F);
+    for (int y = 0; y < valeurs.rows; ++y) {
+        for (int x = 0; x < valeurs.cols; ++x) {
+            double position = valeurs.at<double>(y, x) * nbBins / borneMax;
+            if (position >= 0.0 && position < nbBins) {
+                hist.at<float>(0, static_cast<int>(position)) += 1.0f;
+            }
+        }
+    }
+    return hist;
+}
+
+// L'intégrale comparée à cv::integral, et les filtres boîte à cv::boxFilter et cv::blur
+void testerIntegrale(const std::string& nom, const cv::Mat& image, int largeur, int hauteur) {
+    std::string nomTest = nom + " boite " + std::to_string(largeur) + "x" + std::to_string(hauteur);
+
+    // L'intégrale complète, puis la même construite en deux paquets de lignes
+    cv::Mat sommes, carres;
+    cv::integral(image, sommes, carres, CV_64F, CV_64F);
+    ImageIntegrale<uint32_t> integrale, parPaquets;
+    integrale.calculer(image);
+    parPaquets.calculer(image.rowRange(0, image.rows / 2));
+    parPaquets.ajouterLignes(image.rowRange(image.rows / 2, image.rows));
+    cv::Mat obtenu(image.rows + 1, image.cols + 1, CV_64F), obtenuCarres(obtenu.size(), CV_64F);
+    cv::Mat obtenuPaquets(obtenu.size(), CV_64F);
+    for (int y = 0; y <= image.rows; ++y) {
+        for (int x = 0; x <= image.cols; ++x) {
+            obtenu.at<double>(y, x) = integrale.ligne(y)[x];
+            obtenuCarres.at<double>(y, x) = integrale.ligneCarres(y)[x];
+            obtenuPaquets.at<double>(y, x) = parPaquets.ligne(y)[x];
+        }
+    }
+    verifierImages(nomTest + " ImageIntegrale", obtenu, sommes, 0.0);
+    verifierImages(nomTest + " ImageIntegrale carres", obtenuCarres, carres, 0.0);
+    verifierImages(nomTest + " ImageIntegrale par paquets", obtenuPaquets, sommes, 0.0);
+
+    // Après modification de la seconde moitié, la mise à jour retrouve l'intégrale
+    cv::Mat modifiee = image.clone();
+    modifiee.rowRange(image.rows / 2, image.rows).setTo(cv::Scalar(255));
+    cv::integral(modifiee, sommes, carres, CV_64F, CV_64F);
+    integrale.mettreAJour(modifiee, image.rows / 2);
+    for (int y = 0; y <= image.rows; ++y) {
+        for (int x = 0; x <= image.cols; ++x) {
+            obtenu.at<double>(y, x) = integrale.ligne(y)[x];
+        }
+    }
+    verifierImages(nomTest + " ImageIntegrale mise a jour", obtenu, sommes, 0.0);
+
+    // Filtres boîte : sommes exactes, moyenne arrondie comme cv::blur
+    const ModeBord modes[] = {BORD_REPLIQUE, BORD_REFLET_101, BORD_CONSTANT};
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+        std::string nomMode = nomTest + " bord " + std::to_string(static_cast<int>(modes[m]));
+        cv::Mat attendu;
+        cv::boxFilter(image, attendu, CV_32S, cv::Size(largeur, hauteur), cv::Point(-1, -1), false,
+                      bordOpenCV(modes[m]));
+        verifierImages(nomMode + " sommeBoite", sommeBoite(image, largeur, hauteur, modes[m]), attendu, 0.0);
+        cv::blur(image, attendu, cv::Size(largeur, hauteur), cv::Point(-1, -1), bordOpenCV(modes[m]));
+        verifierImages(nomMode + " moyenneBoite", moyenneBoite(image, largeur, hauteur, modes[m]), attendu, 1.0);
+    }
+
+    // Variance : comparée à E[x^2] - E[x]^2 calculé en double sur cv::boxFilter
+    cv::Mat moyenne, variance, flottante, carresPixels, moyenneAttendue, moyenneCarres;
+    varianceBoite(image, moyenne, variance, largeur, hauteur);
+    image.convertTo(flottante, CV_64F);
+    cv::multiply(flottante, flottante, carresPixels);
+    cv::boxFilter(flottante, moyenneAttendue, CV_64F, cv::Size(largeur, hauteur));
+    cv::boxFilter(carresPixels, moyenneCarres, CV_64F, cv::Size(largeur, hauteur));
+    cv::Mat varianceAttendue(image.size(), CV_64F);
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            double m = moyenneAttendue.at<double>(y, x);
+            varianceAttendue.at<double>(y, x) = moyenneCarres.at<double>(y, x) - m * m;
+        }
+    }
+    verifierImages(nomTest + " varianceBoite moyenne", moyenne, moyenneAttendue, 1e-3);
+    verifierImages(nomTest + " varianceBoite variance", variance, varianceAttendue, 1e-1);
+}
+
+// Images 16 bits, flottantes ou à plusieurs canaux : chaque canal doit donner le même
+// résultat que la référence appliquée au canal seul
+void testerTypes(const std::string& nom, const cv::Mat& image, const std::vector<cv::Mat>& filtres) {
+    std::string nomType = nom + " type " + std::to_string(image.type());
+    double borneMax = image.depth() == CV_8U ? 256.0 : (image.depth() == CV_16U ? 65536.0 : 1.0);
+    // Écart toléré sur une valeur filtrée ou étirée : 1 pour un entier, une petite
+    // fraction de la dynamique pour un flottant
+    double tolerance = image.depth() == CV_32F ? 1e-4 : 1.0;
+
+    std::vector<cv::Mat> canaux;
+    cv::split(image, canaux);
+
+    cv::Mat hist;
+    for (int nbBins = 64; nbBins <= 256; nbBins *= 4) {
+        calculerHistogrammeCanaux(image, hist, nbBins);
+        for (size_t c = 0; c < canaux.size(); ++c) {
+            verifierImages(nomType + " histogramme " + std::to_string(nbBins) + " canal " + std::to_string(c),
+                           hist.row(static_cast<int>(c)), histogrammeReference(canaux[c], nbBins, borneMax), 0.0);
+        }
+    }
+
+    cv::Mat etiree, egalisee;
+    etirerHistogramme(image, etiree, 0, borneMax == 1.0 ? 1.0 : borneMax - 1);
+    egaliserHistogramme(image, egalisee);
+    std::vector<cv::Mat> canauxEtires, canauxEgalises;
+    cv::split(etiree, canauxEtires);
+    cv::split(egalisee, canauxEgalises);
+    for (size_t c = 0; c < canaux.size(); ++c) {
+        std::string nomCanal = nomType + " canal " + std::to_string(c);
+        double minVal, maxVal;
+        cv::minMaxLoc(canaux[c], &minVal, &maxVal);
+        if (minVal < maxVal) {
+            cv::Mat attendu;
+            cv::normalize(canaux[c], attendu, 0, borneMax == 1.0 ? 1.0 : borneMax - 1, cv::NORM_MINMAX);
+            verifierImages(nomCanal + " etirerHistogramme", canauxEtires[c], attendu, tolerance);
+        }
+
+        cv::Mat attendu;
+        egaliserHistogramme(canaux[c], attendu);
+        verifierImages(nomCanal + " egaliserHistogramme", canauxEgalises[c], attendu, 0.0);
+    }
+
+    for (size_t f = 0; f < filtres.size(); ++f) {
+        std::string nomFiltre = nomType + " filtre " + std::to_string(filtres[f].rows) + "x"
+                                + std::to_string(filtres[f].cols);
+        cv::Mat attendu;
+        cv::filter2D(image, attendu, -1, filtres[f]);
+        verifierImages(nomFiltre, appliquerFiltre(image, filtres[f]), attendu, tolerance);
+
+        OptionsFiltre options;
+        options.profondeurSortie = CV_32F;
+        cv::filter2D(image, attendu, CV_32F, filtres[f]);
+        verifierImages(nomFiltre + " CV_32F", appliquerFiltre(image, filtres[f], options), attendu,
+                       image.depth() == CV_16U ? 0.1 : 1e-3);
+    }
+}
+
+// Histogramme et égalisation 16 bits en deux niveaux, comparés à un histogramme dense
+// et à la formule 65535 * cumul / N appliquée pixel par pixel
+void testerHistogramme16(const std::string& nom, const cv::Mat& image) {
+    std::vector<cv::Mat> canaux;
+    cv::split(image, canaux);
+
+    for (int decalage = 0; decalage <= 4; decalage += 4) {
+        cv::Mat egalisee;
+        egaliserHistogramme16(image, egalisee, decalage);
+        std::vector<cv::Mat> canauxEgalises;
+        cv::split(egalisee, canauxEgalises);
+
+        for (size_t c = 0; c < canaux.size(); ++c) {
+            std::string nomTest = nom + " 16 bits decalage " + std::to_string(decalage) + " canal " + std::to_string(c);
+            Histogramme16 hist;
+            calculerHistogramme16(image, hist, decalage, static_cast<int>(c));
+            cv::Mat dense;
+            calculerHistogrammeCanaux(canaux[c], dense, hist.nbCases());
+
+            cv::Mat deuxNiveaux(1, hist.nbCases(), CV_32F);
+            std::vector<uint64_t> table(hist.nbCases());
+            uint64_t cumul = 0;
+            for (int k = 0; k < hist.nbCases(); ++k) {
+                deuxNiveaux.at<float>(0, k) = static_cast<float>(hist.nombre(k));
+                cumul += static_cast<uint64_t>(dense.at<float>(0, k));
+                table[k] = cumul * 65535 / canaux[c].total();
+            }
+            verifierImages(nomTest + " calculerHistogramme16", deuxNiveaux, dense, 0.0);
+
+            cv::Mat attendu(canaux[c].size(), CV_16UC1);
+            for (int y = 0; y < attendu.rows; ++y) {
+                for (int x = 0; x < attendu.cols; ++x) {
+                    attendu.at<ushort>(y, x) = static_cast<ushort>(table[canaux[c].at<ushort>(y, x) >> decalage]);
+                }
+            }
+            verifierImages(nomTest + " egaliserHistogramme16", canauxEgalises[c], attendu, 0.0);
+        }
+    }
+}
+
+void testerImage(const std::string& nom, const cv::Mat& image, const std::vector<cv::Mat>& filtres) {
+    testerHistogramme(nom, image);
+    testerEgalisation(nom, image);
+    testerClahe(nom, image);
+    testerEtirement(nom, image);
+    for (size_t f = 0; f < filtres.size(); ++f) {
+        testerFiltre(nom, image, filtres[f]);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint64_t graine = argc > 1 ? std::strtoull(argv[1], 0, 10) : 12345;
+    int nbAleatoires = argc > 2 ? std::atoi(argv[2]) : 20;
+    cv::RNG rng(graine);
+    std::vector<cv::Mat> filtres = filtresTest(rng);
+
+    testerComptesExacts();
+    testerImageVide();
+
+    // Les images du dépôt
+    std::vector<std::string> chemins;
+    cv::glob("Images/*.png", chemins);
+    for (size_t i = 0; i < chemins.size(); ++i) {
+        cv::Mat image = cv::imread(chemins[i], cv::IMREAD_GRAYSCALE);
+        if (image.empty()) {
+            std::cerr << "ECHEC chargement de " << chemins[i] << std::endl;
+            ++nbEchecs;
+            continue;
+        }
+        testerImage(chemins[i], image, filtres);
+        testerMedian(chemins[i], image, 3 + 2 * static_cast<int>(i % 2));
+        testerGaussRecursif(chemins[i], image, 5.0);
+        testerOtsu(chemins[i], image);
+        testerSeuillageAdaptatif(chemins[i], image, 15);
+        cv::Mat binaire;
+        segmenterOtsu(image, binaire);
+        testerEtiquetage(chemins[i], binaire);
+        testerCroissance(chemins[i], image, rng);
+        testerPartage(chemins[i], image, rng);
+    }
+
+    // Des images aléatoires de tailles quelconques, dont des sous-images non continues
+    // et des images plus petites que les filtres
+    for (int i = 0; i < nbAleatoires; ++i) {
+        int hauteur = rng.uniform(1, 300);
+        int largeur = rng.uniform(1, 300);
+        cv::Mat grande(hauteur + 8, largeur + 8, CV_8UC1);
+        int bas = rng.uniform(0, 200);
+        rng.fill(grande, cv::RNG::UNIFORM, cv::Scalar(bas), cv::Scalar(rng.uniform(bas + 1, 257)));
+
+        cv::Mat image = (i % 2 == 0) ? grande(cv::Rect(3, 5, largeur, hauteur)) : grande;
+        std::string nom = "aleatoire " + std::to_string(i) + " (" + std::to_string(image.cols) + "x"
+                          + std::to_string(image.rows) + ")";
+        testerImage(nom, image, filtres);
+        testerLocal(nom, image, rng.uniform(0, 8));
+        const int taillesMedian[] = {3, 5, 7, 15};
+        testerMedian(nom, image, taillesMedian[i % 4]);
+        testerIntegrale(nom, image, 2 * rng.uniform(0, 6) + 1, 2 * rng.uniform(0, 6) + 1);
+        const double sigmasGauss[] = {3.0, 7.5, 20.0, 60.0};
+        testerGaussRecursif(nom, image, sigmasGauss[i % 4]);
+        testerOtsu(nom, image);
+        const int taillesSeuillage[] = {3, 5, 11, 21};
+        testerSeuillageAdaptatif(nom, image, taillesSeuillage[i % 4]);
+        cv::Mat binaire;
+        cv::threshold(image, binaire, rng.uniform(bas, bas + 64), 255, cv::THRESH_BINARY);
+        testerEtiquetage(nom, binaire);
+        testerCroissance(nom, image, rng);
+        testerPartage(nom, image, rng);
+
+        // Les mêmes dimensions en 16 bits, en flottant et en couleur
+        cv::Mat image16, couleur(hauteur, largeur, CV_8UC3), couleur16, couleurFlottante;
+        image.convertTo(image16, CV_16U, 257.0);
+        rng.fill(couleur, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+        couleur.convertTo(couleur16, CV_16U, 257.0);
+        couleur.convertTo(couleurFlottante, CV_32F, 1.0 / 255.0);
+        testerTypes(nom, image16, filtres);
+        testerTypes(nom, couleur, filtres);
+        testerTypes(nom, couleur16, filtres);
+        testerTypes(nom, couleurFlottante, filtres);
+
+        // Un capteur 12 bits n'occupe que les 16 premiers blocs de l'histogramme 16 bits
+        cv::Mat image12(hauteur, largeur, CV_16UC1);
+        rng.fill(image12, cv::RNG::UNIFORM, cv::Scalar(0), cv::Scalar(4096));
+        testerHistogramme16(nom, image16);
+        testerHistogramme16(nom, couleur16);
+        testerHistogramme16(nom + " 12 bits", image12);
+    }
+
+    // Au-delà d'un rayon de 127, la fenêtre glissante passe à des compteurs 32 bits
+    cv::Mat petite(23, 37, CV_8UC1);
+    rng.fill(petite, cv::RNG::UNIFORM, cv::Scalar(0), cv::Scalar(256));
+    testerLocal("aleatoire 37x23", petite, 130);
+    // Au-delà de 257 x 257, les sommes de carrés d'une fenêtre passent en 64 bits
+    testerIntegrale("aleatoire 37x23", petite, 301, 261);
+    testerSeuillageAdaptatif("aleatoire 37x23", petite, 61);
+    testerSeuillageAdaptatif("aleatoire 37x23", petite, 301);
+
+    // Au-delà de 2^24 pixels, des sommes cumulées en float ne sont plus exactes : sur cet
+    // histogramme (2 + 11 v mod 32 colonnes de 4097 pixels au niveau v), elles donnent
+    // 129 au lieu de 130. Le seuil d'Otsu doit rester celui de cv::threshold.
+    std::vector<uchar> niveauxColonnes;
+    for (int v = 0; v < 256; ++v) {
+        niveauxColonnes.insert(niveauxColonnes.end(), 2 + (11 * v) % 32, static_cast<uchar>(v));
+    }
+    cv::Mat colonnes(4097, static_cast<int>(niveauxColonnes.size()), CV_8UC1);
+    for (int y = 0; y < colonnes.rows; ++y) {
+        std::copy(niveauxColonnes.begin(), niveauxColonnes.end(), colonnes.ptr<uchar>(y));
+    }
+    testerOtsu("colonnes 4480x4097", colonnes);
+
+    std::cout << nbVerifications - nbEchecs << "/" << nbVerifications << " verifications reussies (graine "
+              << graine << ")" << std::endl;
+    return nbEchecs == 0 ? 0 : 1;
+}